@@ -0,0 +1,627 @@
+// Benchmarks for dependency_ptr.hpp. Results are written to stdout as CSV.
+// The same source is built for every check mode: checked (full checks), sampled (DPTR_CHECK_MODE_SAMPLED) and release (NDEBUG).
+
+// the benchmark measures checked builds unless DPTR_BENCH_CHECKED is set to 0
+#if defined(DPTR_BENCH_CHECKED) && !DPTR_BENCH_CHECKED
+#ifndef NDEBUG
+#define NDEBUG
+#endif
+#else
+#undef NDEBUG
+#endif
+
+#include <dependency_ptr.hpp>
+#include <dependency_ptr_array.hpp>
+#include <dependency_handle.hpp>
+#include <guarded_vector.hpp>
+#include <lazy_dependency_ptr.hpp>
+#include <relative_dependency_ptr.hpp>
+#include <relocatable_ptr.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+	#if DPTR_CHECK_MODE == DPTR_CHECK_MODE_FULL
+	constexpr const char* build_mode = "checked";
+	#elif DPTR_CHECK_MODE == DPTR_CHECK_MODE_SAMPLED
+	constexpr const char* build_mode = "sampled";
+	#else
+	constexpr const char* build_mode = "release";
+	#endif
+
+	constexpr dptr::dependency_op_flags bench_ops = dptr::dependency_op::destroy | dptr::dependency_op::move_from | dptr::dependency_op::assign;
+
+	struct non_atomic_counted : public dptr::guarded_dependency<false, bench_ops>
+	{
+		static constexpr const char* name = "non_atomic";
+		int value = 1;
+	};
+	struct atomic_counted : public dptr::guarded_dependency<true, bench_ops>
+	{
+		static constexpr const char* name = "atomic";
+		int value = 1;
+	};
+	struct sharded_counted : public dptr::guarded_dependency<true, bench_ops, dptr::sharded_counter<>>
+	{
+		static constexpr const char* name = "sharded";
+		int value = 1;
+	};
+	struct compact_counted : public dptr::guarded_dependency<true, bench_ops, dptr::compact_counter<true, std::uint32_t>>
+	{
+		static constexpr const char* name = "compact";
+		int value = 1;
+	};
+	struct isolated_counted : public dptr::guarded_dependency<true, bench_ops, dptr::isolated_counter<>>
+	{
+		static constexpr const char* name = "isolated";
+		int value = 1;
+	};
+	// counted by the guarded_arena it is constructed in
+	struct arena_counted : public dptr::arena_dependency<>
+	{
+		static constexpr const char* name = "arena";
+		int value = 1;
+	};
+	// checked by the guarded_vector it is stored in
+	struct element_counted : public dptr::guarded_element<true>
+	{
+		static constexpr const char* name = "element";
+		int value = 1;
+	};
+	// followed by its relocatable_ptrs when it is moved
+	struct relocatable_counted : public dptr::relocatable_dependency<>
+	{
+		static constexpr const char* name = "relocatable";
+		int value = 1;
+	};
+	// not derived from guarded_dependency, counted in the side table
+	struct side_table_counted
+	{
+		static constexpr const char* name = "side_table";
+		int value = 1;
+	};
+}
+DPTR_SIDE_TABLE_DEPENDENCY(side_table_counted);
+
+namespace
+{
+	#if defined(__GNUC__) || defined(__clang__)
+	#define DPTR_BENCH_NOINLINE __attribute__((noinline))
+	#elif defined(_MSC_VER)
+	#define DPTR_BENCH_NOINLINE __declspec(noinline)
+	#else
+	#define DPTR_BENCH_NOINLINE
+	#endif
+
+	// keeps the optimizer from removing the measured code
+	template <typename T>
+	inline void escape(const T& value)
+	{
+		#if defined(__GNUC__) || defined(__clang__)
+		asm volatile("" : : "r"(&value) : "memory");
+		#else
+		static const volatile void* volatile sink;
+		sink = &value;
+		#endif
+	}
+
+	template <typename ptr_t, typename T>
+	inline void reset_to(ptr_t& ptr, T* target)
+	{
+		if constexpr(std::is_pointer_v<ptr_t>)
+			ptr = target;
+		else
+			ptr.reset(target);
+	}
+
+	template <typename ptr_t>
+	inline auto raw(const ptr_t& ptr)
+	{
+		return &*ptr;
+	}
+
+	// runs body(thread_index) on thread_count threads that start at the same time.
+	// returns the elapsed wall clock time in nanoseconds.
+	template <typename body_t>
+	double run_threads(std::size_t thread_count, const body_t& body)
+	{
+		std::atomic<std::size_t> ready{0u};
+		std::atomic<bool> go{false};
+		std::vector<std::thread> threads;
+		threads.reserve(thread_count);
+		for(std::size_t t = 0u; t < thread_count; ++t)
+		{
+			threads.emplace_back([&, t]()
+			{
+				ready.fetch_add(1u);
+				while(!go.load(std::memory_order_acquire)) std::this_thread::yield();
+				body(t);
+			});
+		}
+		while(ready.load() != thread_count) std::this_thread::yield();
+		const auto start = std::chrono::steady_clock::now();
+		go.store(true, std::memory_order_release);
+		for(auto& thread : threads) thread.join();
+		const auto end = std::chrono::steady_clock::now();
+		return std::chrono::duration<double, std::nano>(end - start).count();
+	}
+
+	// --- single pointer operations. every thread works on its own targets.
+	// results are wall clock nanoseconds per operation and thread.
+	template <typename T, typename ptr_t>
+	double construct_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<T> targets(thread_count);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			T* target = &targets[t];
+			for(std::size_t i = 0u; i < iterations; ++i)
+			{
+				ptr_t ptr(target);
+				escape(ptr);
+			}
+		}) / static_cast<double>(iterations);
+	}
+
+	template <typename T, typename ptr_t>
+	double copy_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<T> targets(thread_count);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			const ptr_t source(&targets[t]);
+			for(std::size_t i = 0u; i < iterations; ++i)
+			{
+				ptr_t ptr(source);
+				escape(ptr);
+			}
+		}) / static_cast<double>(iterations);
+	}
+
+	template <typename T, typename ptr_t>
+	double move_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<T> targets(thread_count);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			ptr_t a(&targets[t]);
+			ptr_t b{};
+			for(std::size_t i = 0u; i < iterations; i += 2u)
+			{
+				b = std::move(a);
+				escape(b);
+				a = std::move(b);
+				escape(a);
+			}
+		}) / static_cast<double>(iterations);
+	}
+
+	template <typename T, typename ptr_t>
+	double reset_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<T> targets(thread_count * 2u);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			T* const first = &targets[2u * t];
+			T* const second = &targets[2u * t + 1u];
+			ptr_t ptr(first);
+			for(std::size_t i = 0u; i < iterations; ++i)
+			{
+				reset_to(ptr, (i & 1u) ? first : second);
+				escape(ptr);
+			}
+			reset_to(ptr, static_cast<T*>(nullptr));
+		}) / static_cast<double>(iterations);
+	}
+
+	template <typename T, typename ptr_t>
+	double deref_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<T> targets(thread_count);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			const ptr_t ptr(&targets[t]);
+			int sum = 0;
+			for(std::size_t i = 0u; i < iterations; ++i)
+			{
+				escape(ptr);
+				sum += ptr->value;
+			}
+			escape(sum);
+		}) / static_cast<double>(iterations);
+	}
+
+	// like deref, but through a dependency_handle, which checks the generation of its slot on every access (in all builds)
+	template <typename T>
+	double handle_deref_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<dptr::slot_map<T>> maps(thread_count);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			const dptr::dependency_handle<T> handle = maps[t].emplace();
+			int sum = 0;
+			for(std::size_t i = 0u; i < iterations; ++i)
+			{
+				escape(handle);
+				sum += handle->value;
+			}
+			escape(sum);
+		}) / static_cast<double>(iterations);
+	}
+
+	// like deref, but through a lazy_dependency_ptr which is bound by the first access
+	template <typename T>
+	double lazy_deref_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<T> targets(thread_count);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			const dptr::lazy_dependency_ptr<T> ptr([&targets, t]() { return &targets[t]; });
+			int sum = 0;
+			for(std::size_t i = 0u; i < iterations; ++i)
+			{
+				escape(ptr);
+				sum += ptr->value;
+			}
+			escape(sum);
+		}) / static_cast<double>(iterations);
+	}
+
+	// like deref, but through a relative_dependency_ptr, which has to be stored close to its target
+	template <typename T>
+	double relative_deref_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		struct node
+		{
+			T target;
+			dptr::relative_dependency_ptr<T> ptr;
+		};
+		std::vector<node> nodes(thread_count);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			node& n = nodes[t];
+			n.ptr = &n.target;
+			int sum = 0;
+			for(std::size_t i = 0u; i < iterations; ++i)
+			{
+				escape(n.ptr);
+				sum += n.ptr->value;
+			}
+			escape(sum);
+			n.ptr = nullptr;
+		}) / static_cast<double>(iterations);
+	}
+
+	// passes ptr (or a dependency_ref borrowed from it) by value into a function which is not inlined
+	template <typename param_t>
+	DPTR_BENCH_NOINLINE int read_value(param_t ptr)
+	{
+		escape(ptr);
+		return ptr->value;
+	}
+
+	template <typename T, typename ptr_t, typename param_t>
+	double pass_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<T> targets(thread_count);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			const ptr_t ptr(&targets[t]);
+			int sum = 0;
+			for(std::size_t i = 0u; i < iterations; ++i)
+				sum += read_value<param_t>(ptr);
+			escape(sum);
+		}) / static_cast<double>(iterations);
+	}
+
+	// --- container operations. results are nanoseconds per element and thread.
+	constexpr std::size_t container_targets = 64u;
+
+	template <typename T, typename ptr_t>
+	double container_push_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<T> targets(thread_count * container_targets);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			T* const first = &targets[t * container_targets];
+			std::vector<ptr_t> container;
+			for(std::size_t i = 0u; i < iterations; ++i)
+				container.push_back(first + (i % container_targets));
+			escape(container);
+		}) / static_cast<double>(iterations);
+	}
+
+	template <typename T, typename ptr_t>
+	double container_sort_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<T> targets(thread_count * container_targets);
+		std::vector<std::vector<ptr_t>> containers(thread_count);
+		for(std::size_t t = 0u; t < thread_count; ++t)
+		{
+			std::mt19937 rng(static_cast<unsigned>(t));
+			std::uniform_int_distribution<std::size_t> dist(0u, container_targets - 1u);
+			containers[t].reserve(iterations);
+			for(std::size_t i = 0u; i < iterations; ++i)
+				containers[t].push_back(&targets[t * container_targets + dist(rng)]);
+		}
+		const double ns = run_threads(thread_count, [&](std::size_t t)
+		{
+			std::sort(containers[t].begin(), containers[t].end(), [](const ptr_t& lhs, const ptr_t& rhs) { return raw(lhs) < raw(rhs); });
+			escape(containers[t]);
+		});
+		containers.clear();
+		return ns / static_cast<double>(iterations);
+	}
+
+	// copies and destroys a container of pointers to few distinct targets
+	template <typename T, typename container_t>
+	double container_copy_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		std::vector<T> targets(thread_count * container_targets);
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			container_t container;
+			for(std::size_t i = 0u; i < iterations; ++i)
+				container.push_back(&targets[t * container_targets + i % container_targets]);
+			for(int repetition = 0; repetition < 4; ++repetition)
+			{
+				container_t copy(container);
+				escape(copy);
+			}
+		}) / static_cast<double>(4u * iterations);
+	}
+
+	// --- contention: every thread copies (and destroys) a dependency_ptr to the same shared object
+	template <typename T, typename ptr_t>
+	double shared_copy_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		T shared_object;
+		const ptr_t shared_ptr(&shared_object);
+		return run_threads(thread_count, [&](std::size_t)
+		{
+			int sum = 0;
+			for(std::size_t i = 0u; i < iterations; ++i)
+			{
+				ptr_t local(shared_ptr);
+				escape(local);
+				sum += local->value;
+			}
+			escape(sum);
+		}) / static_cast<double>(iterations);
+	}
+
+	// --- false sharing: half of the threads copy dependency_ptrs to a shared object, the other half reads its payload.
+	// result is nanoseconds per read. with a single thread there are no writers (baseline).
+	template <typename T, typename ptr_t>
+	double shared_read_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		T shared_object;
+		const ptr_t shared_ptr(&shared_object);
+		const std::size_t writers = thread_count / 2u;
+		std::atomic<std::size_t> readers_done{0u};
+		return run_threads(thread_count, [&](std::size_t t)
+		{
+			if(t < writers)
+			{
+				while(readers_done.load(std::memory_order_relaxed) != thread_count - writers)
+				{
+					ptr_t local(shared_ptr);
+					escape(local);
+				}
+				return;
+			}
+			int sum = 0;
+			for(std::size_t i = 0u; i < iterations; ++i)
+			{
+				escape(shared_object);
+				sum += shared_object.value;
+			}
+			escape(sum);
+			readers_done.fetch_add(1u);
+		}) / static_cast<double>(iterations);
+	}
+
+	// --- growth of a container of dependencies without reserve. every reallocation moves all elements.
+	// std::vector checks every moved-from guarded dependency, guarded_vector checks the whole container once.
+	// result is nanoseconds per element.
+	template <typename container_t>
+	double vector_growth_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		return run_threads(thread_count, [&](std::size_t)
+		{
+			for(int repetition = 0; repetition < 4; ++repetition)
+			{
+				container_t container;
+				for(std::size_t i = 0u; i < iterations; ++i)
+					container.emplace_back();
+				escape(container);
+			}
+		}) / static_cast<double>(4u * iterations);
+	}
+
+	// like vector_growth, but every element is referenced by a relocatable_ptr, which is retargeted on every reallocation
+	double vector_retarget_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		return run_threads(thread_count, [&](std::size_t)
+		{
+			for(int repetition = 0; repetition < 4; ++repetition)
+			{
+				std::vector<relocatable_counted> container;
+				std::vector<dptr::relocatable_ptr<relocatable_counted>> ptrs;
+				ptrs.reserve(iterations);
+				for(std::size_t i = 0u; i < iterations; ++i)
+					ptrs.emplace_back(&container.emplace_back());
+				escape(container);
+				ptrs.clear();
+			}
+		}) / static_cast<double>(4u * iterations);
+	}
+
+	// --- bulk teardown: builds a container of objects, references and releases all of them, then destroys the objects.
+	// guarded dependencies check every object on destruction, arena objects are checked once by their arena.
+	// result is nanoseconds per object.
+	template <typename T>
+	double teardown_ns(std::size_t thread_count, std::size_t iterations)
+	{
+		return run_threads(thread_count, [&](std::size_t)
+		{
+			std::vector<T> objects;
+			if constexpr(std::is_base_of_v<dptr::arena_dependency<>, T>)
+			{
+				dptr::guarded_arena<> arena;
+				{
+					const auto binding = arena.bind();
+					objects.resize(iterations);
+				}
+				for(T& object : objects)
+				{
+					const dptr::dependency_ptr<T> ptr(&object);
+					escape(ptr);
+				}
+				arena.assert_unreferenced();
+				// the objects are trivially destructible, a real arena would release its memory without running destructors
+				objects.clear();
+			}
+			else
+			{
+				objects.resize(iterations);
+				for(T& object : objects)
+				{
+					const dptr::dependency_ptr<T> ptr(&object);
+					escape(ptr);
+				}
+				objects.clear();
+			}
+			escape(objects);
+		}) / static_cast<double>(iterations);
+	}
+
+	struct options
+	{
+		std::size_t max_threads = 1u;
+		std::size_t iterations = 1000000u;
+		std::size_t container_size = 100000u;
+		bool header = true;
+	};
+
+	// the bytes_per_object rows report sizeof of the dependency type instead of nanoseconds
+	void print_row(const char* benchmark, const char* pointer, const char* counter, std::size_t threads, double ns_per_op)
+	{
+		std::cout << build_mode << ',' << benchmark << ',' << pointer << ',' << counter << ',' << threads << ',' << ns_per_op << '\n';
+	}
+
+	template <typename T, typename ptr_t>
+	void run_pointer_benchmarks(const char* pointer, const options& opts, std::size_t threads)
+	{
+		print_row("construct", pointer, T::name, threads, construct_ns<T, ptr_t>(threads, opts.iterations));
+		print_row("copy", pointer, T::name, threads, copy_ns<T, ptr_t>(threads, opts.iterations));
+		print_row("move", pointer, T::name, threads, move_ns<T, ptr_t>(threads, opts.iterations));
+		print_row("reset", pointer, T::name, threads, reset_ns<T, ptr_t>(threads, opts.iterations));
+		print_row("deref", pointer, T::name, threads, deref_ns<T, ptr_t>(threads, opts.iterations));
+		using ref_t = std::conditional_t<std::is_pointer_v<ptr_t>, ptr_t, dptr::dependency_ref<T>>;
+		print_row("pass_by_value", pointer, T::name, threads, pass_ns<T, ptr_t, ptr_t>(threads, opts.iterations));
+		print_row("pass_by_ref", pointer, T::name, threads, pass_ns<T, ptr_t, ref_t>(threads, opts.iterations));
+		print_row("container_push", pointer, T::name, threads, container_push_ns<T, ptr_t>(threads, opts.container_size));
+		print_row("container_sort", pointer, T::name, threads, container_sort_ns<T, ptr_t>(threads, opts.container_size));
+		print_row("container_copy", pointer, T::name, threads, container_copy_ns<T, std::vector<ptr_t>>(threads, opts.container_size));
+	}
+
+	template <typename T>
+	void run_type_benchmarks(const options& opts, std::size_t threads)
+	{
+		run_pointer_benchmarks<T, T*>("raw", opts, threads);
+		run_pointer_benchmarks<T, dptr::dependency_ptr<T>>("dependency_ptr", opts, threads);
+		print_row("container_copy", "dependency_ptr_array", T::name, threads, container_copy_ns<T, dptr::dependency_ptr_array<T>>(threads, opts.container_size));
+	}
+
+	options parse_options(int argc, char** argv)
+	{
+		options opts;
+		opts.max_threads = std::max(1u, std::thread::hardware_concurrency());
+		for(int i = 1; i < argc; ++i)
+		{
+			const bool has_value = i + 1 < argc;
+			if(!std::strcmp(argv[i], "--threads") && has_value)
+				opts.max_threads = std::stoul(argv[++i]);
+			else if(!std::strcmp(argv[i], "--iterations") && has_value)
+				opts.iterations = std::stoul(argv[++i]);
+			else if(!std::strcmp(argv[i], "--container-size") && has_value)
+				opts.container_size = std::stoul(argv[++i]);
+			else if(!std::strcmp(argv[i], "--no-header"))
+				opts.header = false;
+			else
+			{
+				std::cerr << "usage: " << argv[0] << " [--threads n] [--iterations n] [--container-size n] [--no-header]" << std::endl;
+				std::exit(EXIT_FAILURE);
+			}
+		}
+		return opts;
+	}
+
+	// 1, 2, 4, ..., max_threads
+	std::vector<std::size_t> thread_counts(std::size_t max_threads)
+	{
+		std::vector<std::size_t> counts;
+		for(std::size_t threads = 1u; threads < max_threads; threads *= 2u)
+			counts.push_back(threads);
+		counts.push_back(max_threads);
+		return counts;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const options opts = parse_options(argc, argv);
+	if(opts.header)
+		std::cout << "mode,benchmark,pointer,counter,threads,ns_per_op\n";
+	print_row("bytes_per_object", "dependency_ptr", non_atomic_counted::name, 1u, sizeof(non_atomic_counted));
+	print_row("bytes_per_object", "dependency_ptr", atomic_counted::name, 1u, sizeof(atomic_counted));
+	print_row("bytes_per_object", "dependency_ptr", sharded_counted::name, 1u, sizeof(sharded_counted));
+	print_row("bytes_per_object", "dependency_ptr", compact_counted::name, 1u, sizeof(compact_counted));
+	print_row("bytes_per_object", "dependency_ptr", isolated_counted::name, 1u, sizeof(isolated_counted));
+	print_row("bytes_per_object", "dependency_ptr", side_table_counted::name, 1u, sizeof(side_table_counted));
+	print_row("bytes_per_object", "dependency_ptr", arena_counted::name, 1u, sizeof(arena_counted));
+	print_row("bytes_per_object", "dependency_ptr", element_counted::name, 1u, sizeof(element_counted));
+	print_row("bytes_per_object", "relocatable_ptr", relocatable_counted::name, 1u, sizeof(relocatable_counted));
+	print_row("bytes_per_object", "dependency_handle", non_atomic_counted::name, 1u, sizeof(dptr::dependency_handle<non_atomic_counted>));
+	print_row("bytes_per_object", "relative_dependency_ptr", non_atomic_counted::name, 1u, sizeof(dptr::relative_dependency_ptr<non_atomic_counted>));
+	for(const std::size_t threads : thread_counts(opts.max_threads))
+	{
+		run_type_benchmarks<non_atomic_counted>(opts, threads);
+		run_type_benchmarks<atomic_counted>(opts, threads);
+		run_type_benchmarks<sharded_counted>(opts, threads);
+		run_type_benchmarks<compact_counted>(opts, threads);
+		run_type_benchmarks<isolated_counted>(opts, threads);
+		run_type_benchmarks<side_table_counted>(opts, threads);
+		print_row("shared_copy", "dependency_ptr", atomic_counted::name, threads, shared_copy_ns<atomic_counted, dptr::dependency_ptr<atomic_counted>>(threads, opts.iterations));
+		print_row("shared_copy", "dependency_ptr", sharded_counted::name, threads, shared_copy_ns<sharded_counted, dptr::dependency_ptr<sharded_counted>>(threads, opts.iterations));
+		print_row("shared_copy", "dependency_ptr", compact_counted::name, threads, shared_copy_ns<compact_counted, dptr::dependency_ptr<compact_counted>>(threads, opts.iterations));
+		print_row("shared_copy", "dependency_ptr", isolated_counted::name, threads, shared_copy_ns<isolated_counted, dptr::dependency_ptr<isolated_counted>>(threads, opts.iterations));
+		print_row("shared_copy", "dependency_ptr", side_table_counted::name, threads, shared_copy_ns<side_table_counted, dptr::dependency_ptr<side_table_counted>>(threads, opts.iterations));
+		print_row("shared_read", "dependency_ptr", atomic_counted::name, threads, shared_read_ns<atomic_counted, dptr::dependency_ptr<atomic_counted>>(threads, opts.iterations));
+		print_row("shared_read", "dependency_ptr", compact_counted::name, threads, shared_read_ns<compact_counted, dptr::dependency_ptr<compact_counted>>(threads, opts.iterations));
+		print_row("shared_read", "dependency_ptr", isolated_counted::name, threads, shared_read_ns<isolated_counted, dptr::dependency_ptr<isolated_counted>>(threads, opts.iterations));
+		print_row("deref", "dependency_handle", non_atomic_counted::name, threads, handle_deref_ns<non_atomic_counted>(threads, opts.iterations));
+		print_row("deref", "relative_dependency_ptr", non_atomic_counted::name, threads, relative_deref_ns<non_atomic_counted>(threads, opts.iterations));
+		print_row("deref", "lazy_dependency_ptr", non_atomic_counted::name, threads, lazy_deref_ns<non_atomic_counted>(threads, opts.iterations));
+		print_row("vector_growth", "std::vector", atomic_counted::name, threads, vector_growth_ns<std::vector<atomic_counted>>(threads, opts.container_size));
+		print_row("vector_growth", "guarded_vector", element_counted::name, threads, vector_growth_ns<dptr::guarded_vector<element_counted>>(threads, opts.container_size));
+		print_row("vector_growth", "relocatable_ptr", relocatable_counted::name, threads, vector_retarget_ns(threads, opts.container_size));
+		print_row("teardown", "dependency_ptr", non_atomic_counted::name, threads, teardown_ns<non_atomic_counted>(threads, opts.container_size));
+		print_row("teardown", "dependency_ptr", arena_counted::name, threads, teardown_ns<arena_counted>(threads, opts.container_size));
+	}
+	return 0;
+}
@@ -24,7 +24,7 @@ function(add_header_only_library target)
         ${ARGN}
     )
     add_library(${target} INTERFACE)
-    target_sources(${target} INTERFACE $<BUILD_INTERFACE:${header_only_SOURCES}>)
+    target_sources(${target} INTERFACE "$<BUILD_INTERFACE:${header_only_SOURCES}>")
     target_include_directories(${target} INTERFACE ${header_only_INCLUDE_DIRS})
     target_link_libraries(${target} INTERFACE ${header_only_LINK_LIBS})
     set_target_cxx_standard_interface(${target} ${header_only_CXX_STD})
@@ -0,0 +1,226 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_ATOMIC_DEPENDENCY_PTR_H_
+#define _DPTR_ATOMIC_DEPENDENCY_PTR_H_
+
+#include "dependency_ptr.hpp"
+
+namespace dptr
+{
+	namespace detail
+	{
+		// Atomically replaceable dependency_pointer_impl. The atomic holds one reference to its target.
+		// A load has to add its reference before the target can be released by a concurrent store. Loads register in one of two
+		// epoch slots, and stores wait for the loads of the slot of the previous epoch before releasing the reference of the replaced target.
+		// Loads never wait for stores (they only retry if a store switched epochs while they registered). Stores, exchanges and successful
+		// compare-exchanges are serialized by a spin lock and wait for at most the loads which started before them.
+		// memory_order arguments are accepted for compatibility with std::atomic<T*>, all operations are sequentially consistent.
+		template <typename T>
+		class atomic_dependency_ptr_impl
+		{
+		public:
+			using value_type = dependency_pointer_impl<T>;
+
+			atomic_dependency_ptr_impl() noexcept;
+			atomic_dependency_ptr_impl(const value_type& desired) noexcept;
+			atomic_dependency_ptr_impl(const atomic_dependency_ptr_impl&) = delete;
+			atomic_dependency_ptr_impl& operator=(const atomic_dependency_ptr_impl&) = delete;
+			atomic_dependency_ptr_impl& operator=(const value_type& desired) noexcept;
+			~atomic_dependency_ptr_impl();
+
+			value_type load(std::memory_order order = std::memory_order_seq_cst, source_site site = source_site::current()) const noexcept;
+			operator value_type() const noexcept;
+			void store(const value_type& desired, std::memory_order order = std::memory_order_seq_cst) noexcept;
+			value_type exchange(const value_type& desired, std::memory_order order = std::memory_order_seq_cst, source_site site = source_site::current()) noexcept;
+			// on failure, expected is set to the current value
+			bool compare_exchange_strong(value_type& expected, const value_type& desired, std::memory_order order = std::memory_order_seq_cst) noexcept;
+			bool compare_exchange_strong(value_type& expected, const value_type& desired, std::memory_order success, std::memory_order failure) noexcept;
+			bool compare_exchange_weak(value_type& expected, const value_type& desired, std::memory_order order = std::memory_order_seq_cst) noexcept;
+			bool compare_exchange_weak(value_type& expected, const value_type& desired, std::memory_order success, std::memory_order failure) noexcept;
+			bool is_lock_free() const noexcept;
+		private:
+			void lock() noexcept;
+			void unlock() noexcept;
+			// swaps in desired (whose reference is taken over) and waits until no load can still add a reference to the old target
+			T* replace(T* desired) noexcept;
+
+			std::atomic<T*> m_ptr;
+			mutable std::atomic<std::uint64_t> m_epoch;
+			mutable std::atomic<std::size_t> m_loads[2];
+			std::atomic<bool> m_locked;
+		};
+	}
+
+	// Atomic dependency_ptr for publishing shared dependencies (e.g. hot reloaded configurations) to many reader threads.
+	// load() returns a dependency_ptr and keeps the reference counts correct in checked builds. std::atomic<T*> in release builds.
+	// Requires a thread-safe reference counter (atomic guarded dependency or side table dependency).
+	template <typename T>
+	using atomic_dependency_ptr = detail::check_mode_choice_t<dependency_check_mode_v<T>, detail::atomic_dependency_ptr_impl<T>, std::atomic<T*>>;
+}
+
+#pragma region implementation
+template <typename T>
+inline dptr::detail::atomic_dependency_ptr_impl<T>::atomic_dependency_ptr_impl() noexcept :
+	m_ptr(nullptr),
+	m_epoch(0u),
+	m_loads{},
+	m_locked(false)
+{
+}
+template <typename T>
+inline dptr::detail::atomic_dependency_ptr_impl<T>::atomic_dependency_ptr_impl(const value_type& desired) noexcept :
+	atomic_dependency_ptr_impl()
+{
+	T* const ptr = desired.get();
+	if(ptr) intrusive_ptr_add_ref(ptr);
+	m_ptr.store(ptr, std::memory_order_relaxed);
+}
+template <typename T>
+inline dptr::detail::atomic_dependency_ptr_impl<T>& dptr::detail::atomic_dependency_ptr_impl<T>::operator=(const value_type& desired) noexcept
+{
+	store(desired);
+	return *this;
+}
+template <typename T>
+inline dptr::detail::atomic_dependency_ptr_impl<T>::~atomic_dependency_ptr_impl()
+{
+	// checked here instead of in the class, where T may still be incomplete
+	static_assert(is_ref_counter_atomic<T>::value, "[dptr::detail::atomic_dependency_ptr_impl]: atomic_dependency_ptr requires a thread-safe reference counter.");
+	T* const ptr = m_ptr.load(std::memory_order_acquire);
+	if(ptr) intrusive_ptr_release(ptr);
+}
+template <typename T>
+inline typename dptr::detail::atomic_dependency_ptr_impl<T>::value_type dptr::detail::atomic_dependency_ptr_impl<T>::load(std::memory_order, source_site site) const noexcept
+{
+	// register in the slot of the current epoch. retry if a store switched epochs in between, it may not wait for this slot.
+	std::atomic<std::size_t>* slot;
+	for(;;)
+	{
+		const std::uint64_t epoch = m_epoch.load();
+		slot = &m_loads[epoch & 1u];
+		slot->fetch_add(1u);
+		if(m_epoch.load() == epoch) break;
+		slot->fetch_sub(1u, std::memory_order_release);
+	}
+	T* const ptr = m_ptr.load();
+	if(ptr) intrusive_ptr_add_ref(ptr);
+	slot->fetch_sub(1u, std::memory_order_release);
+	return value_type(ptr, false, site);
+}
+template <typename T>
+inline dptr::detail::atomic_dependency_ptr_impl<T>::operator value_type() const noexcept
+{
+	return load();
+}
+template <typename T>
+inline void dptr::detail::atomic_dependency_ptr_impl<T>::store(const value_type& desired, std::memory_order) noexcept
+{
+	T* const ptr = desired.get();
+	if(ptr) intrusive_ptr_add_ref(ptr);
+	lock();
+	T* const old = replace(ptr);
+	unlock();
+	if(old) intrusive_ptr_release(old);
+}
+template <typename T>
+inline typename dptr::detail::atomic_dependency_ptr_impl<T>::value_type dptr::detail::atomic_dependency_ptr_impl<T>::exchange(const value_type& desired, std::memory_order, source_site site) noexcept
+{
+	T* const ptr = desired.get();
+	if(ptr) intrusive_ptr_add_ref(ptr);
+	lock();
+	T* const old = replace(ptr);
+	unlock();
+	// the reference of the atomic is handed over to the returned pointer
+	return value_type(old, false, site);
+}
+template <typename T>
+inline bool dptr::detail::atomic_dependency_ptr_impl<T>::compare_exchange_strong(value_type& expected, const value_type& desired, std::memory_order order) noexcept
+{
+	return compare_exchange_strong(expected, desired, order, order);
+}
+template <typename T>
+inline bool dptr::detail::atomic_dependency_ptr_impl<T>::compare_exchange_strong(value_type& expected, const value_type& desired, std::memory_order, std::memory_order) noexcept
+{
+	T* const ptr = desired.get();
+	lock();
+	T* const current = m_ptr.load();
+	if(current != expected.get())
+	{
+		// current cannot be released while the lock is held
+		value_type observed(current);
+		unlock();
+		expected = observed;
+		return false;
+	}
+	if(ptr) intrusive_ptr_add_ref(ptr);
+	T* const old = replace(ptr);
+	unlock();
+	if(old) intrusive_ptr_release(old);
+	return true;
+}
+template <typename T>
+inline bool dptr::detail::atomic_dependency_ptr_impl<T>::compare_exchange_weak(value_type& expected, const value_type& desired, std::memory_order order) noexcept
+{
+	return compare_exchange_strong(expected, desired, order, order);
+}
+template <typename T>
+inline bool dptr::detail::atomic_dependency_ptr_impl<T>::compare_exchange_weak(value_type& expected, const value_type& desired, std::memory_order success, std::memory_order failure) noexcept
+{
+	return compare_exchange_strong(expected, desired, success, failure);
+}
+template <typename T>
+inline bool dptr::detail::atomic_dependency_ptr_impl<T>::is_lock_free() const noexcept
+{
+	// loads are, stores are serialized
+	return false;
+}
+template <typename T>
+inline void dptr::detail::atomic_dependency_ptr_impl<T>::lock() noexcept
+{
+	for(unsigned spins = 0u; m_locked.exchange(true, std::memory_order_acquire); ++spins)
+	{
+		while(m_locked.load(std::memory_order_relaxed))
+			if(++spins > 64u) std::this_thread::yield();
+	}
+}
+template <typename T>
+inline void dptr::detail::atomic_dependency_ptr_impl<T>::unlock() noexcept
+{
+	m_locked.store(false, std::memory_order_release);
+}
+template <typename T>
+inline T* dptr::detail::atomic_dependency_ptr_impl<T>::replace(T* desired) noexcept
+{
+	T* const old = m_ptr.exchange(desired);
+	// loads registered in the previous epoch may have read old, later loads read desired (or a later value)
+	const std::uint64_t epoch = m_epoch.fetch_add(1u);
+	for(unsigned spins = 0u; m_loads[epoch & 1u].load(std::memory_order_acquire) != 0u; ++spins)
+		if(spins > 64u) std::this_thread::yield();
+	return old;
+}
+#pragma endregion
+#endif
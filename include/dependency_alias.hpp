@@ -0,0 +1,472 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_DEPENDENCY_ALIAS_H_
+#define _DPTR_DEPENDENCY_ALIAS_H_
+
+#include "dependency_ptr.hpp"
+
+#include <iterator>
+
+namespace dptr
+{
+	namespace detail
+	{
+		// reference counting functions of an owner type, shared by all references to owners of that type
+		struct owner_ops
+		{
+			void (*add_ref)(const void*) noexcept;
+			void (*release)(const void*) noexcept;
+		};
+		template <typename U>
+		struct owner_ops_of
+		{
+			static void add_ref(const void* owner) noexcept { intrusive_ptr_add_ref(static_cast<const U*>(owner)); }
+			static void release(const void* owner) noexcept { intrusive_ptr_release(static_cast<const U*>(owner)); }
+			static constexpr owner_ops value{&add_ref, &release};
+		};
+
+		// owner of an alias or span: a raw pointer or a dependency_ptr
+		template <typename U>
+		U* owner_pointer(U* owner) noexcept { return owner; }
+		template <typename U>
+		U* owner_pointer(const dependency_pointer_impl<U>& owner) noexcept { return owner.get(); }
+		template <typename owner_ptr_t>
+		using owner_pointer_t = decltype(owner_pointer(std::declval<const owner_ptr_t&>()));
+		// owner_ptr_t (T* or dependency_ptr) can own the aliases and spans of owner_t (void: any owner)
+		template <typename owner_ptr_t, typename owner_t>
+		using enable_owner_t = std::enable_if_t<std::is_void_v<owner_t> || std::is_convertible_v<owner_pointer_t<owner_ptr_t>, const owner_t*>>;
+		// aliases and spans of any owner always store the reference, the owner's type decides whether it is counted
+		template <typename owner_t>
+		constexpr bool counts_owner_v = std::is_void_v<owner_t> || dependency_check_mode_v<owner_t> != check_mode::off;
+
+		#pragma region owner_reference
+		// One reference to the checked dependency owning the referenced memory. Owners of unchecked types are not counted.
+		template <bool counted>
+		class owner_reference
+		{
+		public:
+			owner_reference() noexcept = default;
+			template <typename U>
+			explicit owner_reference(U* owner) noexcept;
+			owner_reference(const owner_reference& other) noexcept;
+			owner_reference(owner_reference&& other) noexcept;
+			owner_reference& operator=(const owner_reference& other) noexcept;
+			owner_reference& operator=(owner_reference&& other) noexcept;
+			~owner_reference();
+
+			// address of the owner, nullptr if it is not counted
+			const void* owner() const noexcept { return m_owner; }
+		private:
+			const void* m_owner = nullptr;
+			const owner_ops* m_ops = nullptr;
+		};
+
+		// --- release variant, does not count anything
+		template <>
+		class owner_reference<false>
+		{
+		public:
+			owner_reference() noexcept = default;
+			template <typename U>
+			explicit owner_reference(U*) noexcept {}
+			const void* owner() const noexcept { return nullptr; }
+		};
+		#pragma endregion
+
+		#pragma region alias_ptr
+		// pointer to a (sub)object of an owner, counted against the owner
+		template <typename T, typename owner_t>
+		class alias_ptr : private owner_reference<counts_owner_v<owner_t>>
+		{
+			template <typename U, typename> friend class alias_ptr;
+			using owner_base = owner_reference<counts_owner_v<owner_t>>;
+			static constexpr bool checked = dependency_check_mode_v<owner_t> != check_mode::off;
+		public:
+			using element_type = T;
+			using pointer = T*;
+
+			alias_ptr() noexcept;
+			alias_ptr(std::nullptr_t) noexcept;
+			// like std::shared_ptr's aliasing constructor: points to ptr and references owner (T* or dependency_ptr)
+			template <typename owner_ptr_t, typename = enable_owner_t<owner_ptr_t, owner_t>>
+			alias_ptr(const owner_ptr_t& owner, T* ptr) noexcept;
+			template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+			alias_ptr(const alias_ptr<U, owner_t>& other) noexcept;
+			alias_ptr(const alias_ptr& other) noexcept = default;
+			alias_ptr(alias_ptr&& other) noexcept;
+			alias_ptr& operator=(const alias_ptr& other) noexcept = default;
+			alias_ptr& operator=(alias_ptr&& other) noexcept;
+			alias_ptr& operator=(std::nullptr_t) noexcept;
+			~alias_ptr() = default;
+
+			void reset() noexcept;
+
+			T& operator*() const noexcept;
+			T* operator->() const noexcept;
+			T* get() const noexcept;
+			explicit operator bool() const noexcept;
+			operator T*() const noexcept;
+			using owner_base::owner;
+		private:
+			T* m_ptr;
+		};
+		#pragma endregion
+
+		#pragma region span_impl
+		// contiguous range owned by an owner, counted once against the owner
+		template <typename T, typename owner_t>
+		class span_impl : private owner_reference<counts_owner_v<owner_t>>
+		{
+			template <typename U, typename> friend class span_impl;
+			using owner_base = owner_reference<counts_owner_v<owner_t>>;
+			static constexpr bool checked = dependency_check_mode_v<owner_t> != check_mode::off;
+		public:
+			using element_type = T;
+			using value_type = std::remove_cv_t<T>;
+			using size_type = std::size_t;
+			using difference_type = std::ptrdiff_t;
+			using pointer = T*;
+			using reference = T&;
+			using iterator = T*;
+
+			span_impl() noexcept;
+			template <typename owner_ptr_t, typename = enable_owner_t<owner_ptr_t, owner_t>>
+			span_impl(const owner_ptr_t& owner, T* data, size_type size) noexcept;
+			// range of a contiguous container (or array) inside the owner
+			template <typename owner_ptr_t, typename container_t, typename = enable_owner_t<owner_ptr_t, owner_t>,
+				typename = std::enable_if_t<std::is_convertible_v<decltype(std::data(std::declval<container_t&>())), T*>>>
+			span_impl(const owner_ptr_t& owner, container_t& container) noexcept;
+			// span<U> -> span<const U>
+			template <typename U, typename = std::enable_if_t<std::is_convertible_v<U(*)[], T(*)[]>>>
+			span_impl(const span_impl<U, owner_t>& other) noexcept;
+			span_impl(const span_impl& other) noexcept = default;
+			span_impl(span_impl&& other) noexcept;
+			span_impl& operator=(const span_impl& other) noexcept = default;
+			span_impl& operator=(span_impl&& other) noexcept;
+			~span_impl() = default;
+
+			T* data() const noexcept;
+			size_type size() const noexcept;
+			size_type size_bytes() const noexcept;
+			bool empty() const noexcept;
+			T& operator[](size_type pos) const noexcept;
+			T& front() const noexcept;
+			T& back() const noexcept;
+			iterator begin() const noexcept;
+			iterator end() const noexcept;
+
+			// subranges reference the same owner
+			span_impl first(size_type count) const noexcept;
+			span_impl last(size_type count) const noexcept;
+			span_impl subspan(size_type offset, size_type count = static_cast<size_type>(-1)) const noexcept;
+			using owner_base::owner;
+		private:
+			span_impl(const owner_base& owner, T* data, size_type size) noexcept;
+			T* m_data;
+			size_type m_size;
+		};
+		#pragma endregion
+	}
+
+	// Pointer to a member, element or other subobject of a dependency which counts against the dependency instead of the subobject,
+	// like std::shared_ptr's aliasing constructor. The subobject does not need its own counter:
+	// dependency_alias<float> x(mesh_ptr, &mesh_ptr->bounds.x);
+	// The owner can be a T* or a dependency_ptr to a checked dependency, owners of unchecked types are not counted. Holders are not tracked.
+	// Whether the owner is counted depends on the check mode of its type. By default (owner_t = void), any owner can be referenced and the
+	// alias stores the owner reference in all builds (three pointers). With an owner type, only owners convertible to owner_t* are accepted,
+	// and the alias is a plain pointer (sizeof(T*)) if dependency_check_mode<owner_t> is off: dependency_alias<float, mesh>.
+	template <typename T, typename owner_t = void>
+	using dependency_alias = detail::alias_ptr<T, owner_t>;
+
+	// View of a contiguous range inside a dependency (e.g. an element array), pinned by a single reference to the dependency.
+	// The elements do not need counters: dependency_span<vertex> vertices(&mesh, mesh.vertices);
+	// Subranges (first, last, subspan) reference the same owner. Counts like dependency_alias: with an owner type whose check mode is off,
+	// the span is a pointer and a size.
+	// The span only prevents destroying (or moving, assigning, depending on the forbidden operations) the owner, resizing a container
+	// of the owner is not detected.
+	template <typename T, typename owner_t = void>
+	using dependency_span = detail::span_impl<T, owner_t>;
+}
+
+#pragma region implementation
+// --- owner_reference
+template <bool counted>
+template <typename U>
+inline dptr::detail::owner_reference<counted>::owner_reference(U* owner) noexcept
+{
+	using owner_t = std::remove_cv_t<U>;
+	if constexpr(is_checked_dependency_v<owner_t>)
+	{
+		if(!owner) return;
+		m_owner = owner;
+		m_ops = &owner_ops_of<owner_t>::value;
+		m_ops->add_ref(m_owner);
+	}
+}
+template <bool counted>
+inline dptr::detail::owner_reference<counted>::owner_reference(const owner_reference& other) noexcept :
+	m_owner(other.m_owner),
+	m_ops(other.m_ops)
+{
+	if(m_owner) m_ops->add_ref(m_owner);
+}
+template <bool counted>
+inline dptr::detail::owner_reference<counted>::owner_reference(owner_reference&& other) noexcept :
+	m_owner(std::exchange(other.m_owner, nullptr)),
+	m_ops(std::exchange(other.m_ops, nullptr))
+{
+}
+template <bool counted>
+inline dptr::detail::owner_reference<counted>& dptr::detail::owner_reference<counted>::operator=(const owner_reference& other) noexcept
+{
+	// add first, other may reference the same owner
+	if(other.m_owner) other.m_ops->add_ref(other.m_owner);
+	if(m_owner) m_ops->release(m_owner);
+	m_owner = other.m_owner;
+	m_ops = other.m_ops;
+	return *this;
+}
+template <bool counted>
+inline dptr::detail::owner_reference<counted>& dptr::detail::owner_reference<counted>::operator=(owner_reference&& other) noexcept
+{
+	if(&other != this)
+	{
+		if(m_owner) m_ops->release(m_owner);
+		m_owner = std::exchange(other.m_owner, nullptr);
+		m_ops = std::exchange(other.m_ops, nullptr);
+	}
+	return *this;
+}
+template <bool counted>
+inline dptr::detail::owner_reference<counted>::~owner_reference()
+{
+	if(m_owner) m_ops->release(m_owner);
+}
+
+// --- alias_ptr
+template <typename T, typename owner_t>
+inline dptr::detail::alias_ptr<T, owner_t>::alias_ptr() noexcept :
+	owner_base(),
+	m_ptr(nullptr)
+{
+}
+template <typename T, typename owner_t>
+inline dptr::detail::alias_ptr<T, owner_t>::alias_ptr(std::nullptr_t) noexcept :
+	alias_ptr()
+{
+}
+template <typename T, typename owner_t>
+template <typename owner_ptr_t, typename>
+inline dptr::detail::alias_ptr<T, owner_t>::alias_ptr(const owner_ptr_t& owner, T* ptr) noexcept :
+	owner_base(owner_pointer(owner)),
+	m_ptr(ptr)
+{
+}
+template <typename T, typename owner_t>
+template <typename U, typename>
+inline dptr::detail::alias_ptr<T, owner_t>::alias_ptr(const alias_ptr<U, owner_t>& other) noexcept :
+	owner_base(static_cast<const owner_base&>(other)),
+	m_ptr(other.m_ptr)
+{
+}
+template <typename T, typename owner_t>
+inline dptr::detail::alias_ptr<T, owner_t>::alias_ptr(alias_ptr&& other) noexcept :
+	owner_base(std::move(other)),
+	m_ptr(std::exchange(other.m_ptr, nullptr))
+{
+}
+template <typename T, typename owner_t>
+inline dptr::detail::alias_ptr<T, owner_t>& dptr::detail::alias_ptr<T, owner_t>::operator=(alias_ptr&& other) noexcept
+{
+	owner_base::operator=(std::move(other));
+	if(&other != this) m_ptr = std::exchange(other.m_ptr, nullptr);
+	return *this;
+}
+template <typename T, typename owner_t>
+inline dptr::detail::alias_ptr<T, owner_t>& dptr::detail::alias_ptr<T, owner_t>::operator=(std::nullptr_t) noexcept
+{
+	reset();
+	return *this;
+}
+template <typename T, typename owner_t>
+inline void dptr::detail::alias_ptr<T, owner_t>::reset() noexcept
+{
+	owner_base::operator=(owner_base());
+	m_ptr = nullptr;
+}
+template <typename T, typename owner_t>
+inline T& dptr::detail::alias_ptr<T, owner_t>::operator*() const noexcept
+{
+	DPTR_PRECONDITION(checked, m_ptr, "[dptr::dependency_alias::operator*]: nullptr access.");
+	return *m_ptr;
+}
+template <typename T, typename owner_t>
+inline T* dptr::detail::alias_ptr<T, owner_t>::operator->() const noexcept
+{
+	DPTR_PRECONDITION(checked, m_ptr, "[dptr::dependency_alias::operator->]: nullptr access.");
+	return m_ptr;
+}
+template <typename T, typename owner_t>
+inline T* dptr::detail::alias_ptr<T, owner_t>::get() const noexcept
+{
+	return m_ptr;
+}
+template <typename T, typename owner_t>
+inline dptr::detail::alias_ptr<T, owner_t>::operator bool() const noexcept
+{
+	return m_ptr;
+}
+template <typename T, typename owner_t>
+inline dptr::detail::alias_ptr<T, owner_t>::operator T*() const noexcept
+{
+	return m_ptr;
+}
+
+// --- span_impl
+template <typename T, typename owner_t>
+inline dptr::detail::span_impl<T, owner_t>::span_impl() noexcept :
+	owner_base(),
+	m_data(nullptr),
+	m_size(0u)
+{
+}
+template <typename T, typename owner_t>
+template <typename owner_ptr_t, typename>
+inline dptr::detail::span_impl<T, owner_t>::span_impl(const owner_ptr_t& owner, T* data, size_type size) noexcept :
+	owner_base(owner_pointer(owner)),
+	m_data(data),
+	m_size(size)
+{
+}
+template <typename T, typename owner_t>
+template <typename owner_ptr_t, typename container_t, typename, typename>
+inline dptr::detail::span_impl<T, owner_t>::span_impl(const owner_ptr_t& owner, container_t& container) noexcept :
+	span_impl(owner, std::data(container), std::size(container))
+{
+}
+template <typename T, typename owner_t>
+template <typename U, typename>
+inline dptr::detail::span_impl<T, owner_t>::span_impl(const span_impl<U, owner_t>& other) noexcept :
+	owner_base(static_cast<const owner_base&>(other)),
+	m_data(other.m_data),
+	m_size(other.m_size)
+{
+}
+template <typename T, typename owner_t>
+inline dptr::detail::span_impl<T, owner_t>::span_impl(span_impl&& other) noexcept :
+	owner_base(std::move(other)),
+	m_data(std::exchange(other.m_data, nullptr)),
+	m_size(std::exchange(other.m_size, 0u))
+{
+}
+template <typename T, typename owner_t>
+inline dptr::detail::span_impl<T, owner_t>::span_impl(const owner_base& owner, T* data, size_type size) noexcept :
+	owner_base(owner),
+	m_data(data),
+	m_size(size)
+{
+}
+template <typename T, typename owner_t>
+inline dptr::detail::span_impl<T, owner_t>& dptr::detail::span_impl<T, owner_t>::operator=(span_impl&& other) noexcept
+{
+	owner_base::operator=(std::move(other));
+	if(&other != this)
+	{
+		m_data = std::exchange(other.m_data, nullptr);
+		m_size = std::exchange(other.m_size, 0u);
+	}
+	return *this;
+}
+template <typename T, typename owner_t>
+inline T* dptr::detail::span_impl<T, owner_t>::data() const noexcept
+{
+	return m_data;
+}
+template <typename T, typename owner_t>
+inline typename dptr::detail::span_impl<T, owner_t>::size_type dptr::detail::span_impl<T, owner_t>::size() const noexcept
+{
+	return m_size;
+}
+template <typename T, typename owner_t>
+inline typename dptr::detail::span_impl<T, owner_t>::size_type dptr::detail::span_impl<T, owner_t>::size_bytes() const noexcept
+{
+	return m_size * sizeof(T);
+}
+template <typename T, typename owner_t>
+inline bool dptr::detail::span_impl<T, owner_t>::empty() const noexcept
+{
+	return m_size == 0u;
+}
+template <typename T, typename owner_t>
+inline T& dptr::detail::span_impl<T, owner_t>::operator[](size_type pos) const noexcept
+{
+	DPTR_PRECONDITION(checked, pos < m_size, "[dptr::dependency_span::operator[]]: Index out of range.");
+	return m_data[pos];
+}
+template <typename T, typename owner_t>
+inline T& dptr::detail::span_impl<T, owner_t>::front() const noexcept
+{
+	return (*this)[0u];
+}
+template <typename T, typename owner_t>
+inline T& dptr::detail::span_impl<T, owner_t>::back() const noexcept
+{
+	return (*this)[m_size - 1u];
+}
+template <typename T, typename owner_t>
+inline typename dptr::detail::span_impl<T, owner_t>::iterator dptr::detail::span_impl<T, owner_t>::begin() const noexcept
+{
+	return m_data;
+}
+template <typename T, typename owner_t>
+inline typename dptr::detail::span_impl<T, owner_t>::iterator dptr::detail::span_impl<T, owner_t>::end() const noexcept
+{
+	return m_data + m_size;
+}
+template <typename T, typename owner_t>
+inline dptr::detail::span_impl<T, owner_t> dptr::detail::span_impl<T, owner_t>::first(size_type count) const noexcept
+{
+	DPTR_PRECONDITION(checked, count <= m_size, "[dptr::dependency_span::first]: count out of range.");
+	return span_impl(*this, m_data, count);
+}
+template <typename T, typename owner_t>
+inline dptr::detail::span_impl<T, owner_t> dptr::detail::span_impl<T, owner_t>::last(size_type count) const noexcept
+{
+	DPTR_PRECONDITION(checked, count <= m_size, "[dptr::dependency_span::last]: count out of range.");
+	return span_impl(*this, m_data + (m_size - count), count);
+}
+template <typename T, typename owner_t>
+inline dptr::detail::span_impl<T, owner_t> dptr::detail::span_impl<T, owner_t>::subspan(size_type offset, size_type count) const noexcept
+{
+	DPTR_PRECONDITION(checked, offset <= m_size, "[dptr::dependency_span::subspan]: offset out of range.");
+	const size_type remaining = m_size - offset;
+	if(count == static_cast<size_type>(-1)) count = remaining;
+	DPTR_PRECONDITION(checked, count <= remaining, "[dptr::dependency_span::subspan]: count out of range.");
+	return span_impl(*this, m_data + offset, count);
+}
+#pragma endregion
+#endif
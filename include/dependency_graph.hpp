@@ -0,0 +1,366 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+// 
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+// 
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_DEPENDENCY_GRAPH_H_
+#define _DPTR_DEPENDENCY_GRAPH_H_
+
+#include "dependency_ptr.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#if defined(__has_include)
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#include <cstdlib>
+#define DPTR_GRAPH_HAS_CXXABI 1
+#endif
+#endif
+
+namespace dptr
+{
+	namespace detail
+	{
+		// readable type name from std::type_info::name
+		inline std::string demangle(const char* name);
+		inline void write_json_string(std::ostream& stream, const std::string& str);
+	}
+
+	// Snapshot of the dependency graph formed by the live dependency_ptrs. Requires DPTR_TRACK_HOLDERS, empty otherwise.
+	// Nodes are the objects referenced by at least one dependency_ptr. An edge leads from the object containing a dependency_ptr
+	// to the object it references. dependency_ptrs outside of any node (locals, globals, unreferenced roots) are external edges.
+	class dependency_graph
+	{
+	public:
+		static constexpr std::size_t external = static_cast<std::size_t>(-1);
+
+		struct node
+		{
+			// complete object and its guarded_dependency base
+			const void* object;
+			const void* dependency;
+			// largest sizeof of the pointee types of its holders, a lower bound for polymorphic types
+			std::size_t size;
+			std::string type_name;
+			// dependency_ptrs referencing this object (including external ones)
+			std::size_t in_degree;
+			// dependency_ptrs stored inside this object
+			std::size_t out_degree;
+		};
+		struct edge
+		{
+			// node index or external
+			std::size_t from;
+			std::size_t to;
+			const void* holder;
+			const char* file;
+			unsigned line;
+		};
+
+		// collects the live dependency_ptrs. locks one thread registry at a time, so other threads keep running.
+		// pointers changed concurrently on other threads may or may not be part of the snapshot.
+		static dependency_graph snapshot();
+
+		const std::vector<node>& nodes() const noexcept { return m_nodes; }
+		const std::vector<edge>& edges() const noexcept { return m_edges; }
+
+		// strongly connected components with more than one node or a self reference (node indices)
+		std::vector<std::vector<std::size_t>> cycles() const;
+		// node indices ordered such that every object comes before the objects it references, i.e. a valid destruction order.
+		// nodes on cycles have no valid order and are appended at the end.
+		std::vector<std::size_t> teardown_order() const;
+
+		void write_dot(std::ostream& stream) const;
+		void write_json(std::ostream& stream) const;
+	private:
+		std::vector<node> m_nodes;
+		std::vector<edge> m_edges;
+	};
+}
+
+#pragma region implementation
+// --- helpers
+inline std::string dptr::detail::demangle(const char* name)
+{
+	if(!name) return "?";
+	#ifdef DPTR_GRAPH_HAS_CXXABI
+	int status = 0;
+	char* demangled = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+	if(status == 0 && demangled)
+	{
+		std::string result(demangled);
+		std::free(demangled);
+		return result;
+	}
+	#endif
+	return name;
+}
+inline void dptr::detail::write_json_string(std::ostream& stream, const std::string& str)
+{
+	stream << '"';
+	for(const char c : str)
+	{
+		if(c == '"' || c == '\\') stream << '\\' << c;
+		else if(static_cast<unsigned char>(c) < 0x20u) stream << ' ';
+		else stream << c;
+	}
+	stream << '"';
+}
+
+// --- dependency_graph
+
+inline dptr::dependency_graph dptr::dependency_graph::snapshot()
+{
+	dependency_graph graph;
+	#if DPTR_TRACK_HOLDERS
+	std::vector<holder_info> holders;
+	for_each_holder([&](const holder_info& holder) { holders.push_back(holder); });
+
+	// one node per referenced object
+	std::unordered_map<const void*, std::size_t> node_indices;
+	for(const holder_info& holder : holders)
+	{
+		const auto inserted = node_indices.emplace(holder.dependency, graph.m_nodes.size());
+		if(inserted.second)
+			graph.m_nodes.push_back({holder.object, holder.dependency, holder.object_size, detail::demangle(holder.type_name), 0u, 0u});
+		else
+			graph.m_nodes[inserted.first->second].size = std::max(graph.m_nodes[inserted.first->second].size, holder.object_size);
+	}
+
+	// nodes sorted by address to find the object containing a holder
+	std::vector<std::size_t> by_address(graph.m_nodes.size());
+	for(std::size_t i = 0u; i < by_address.size(); ++i) by_address[i] = i;
+	std::sort(by_address.begin(), by_address.end(), [&](std::size_t lhs, std::size_t rhs)
+	{
+		return std::less<const void*>()(graph.m_nodes[lhs].object, graph.m_nodes[rhs].object);
+	});
+	// end of the furthest reaching object among the first i + 1 nodes in address order
+	std::vector<const unsigned char*> reach(by_address.size());
+	for(std::size_t i = 0u; i < by_address.size(); ++i)
+	{
+		const node& n = graph.m_nodes[by_address[i]];
+		const auto* const end = static_cast<const unsigned char*>(n.object) + n.size;
+		reach[i] = i == 0u || std::less<const void*>()(reach[i - 1u], end) ? end : reach[i - 1u];
+	}
+	const auto containing_node = [&](const void* address)
+	{
+		const auto* const byte = static_cast<const unsigned char*>(address);
+		std::size_t i = static_cast<std::size_t>(std::upper_bound(by_address.begin(), by_address.end(), address, [&](const void* value, std::size_t index)
+		{
+			return std::less<const void*>()(value, graph.m_nodes[index].object);
+		}) - by_address.begin());
+		// the closest preceding object may be a smaller neighbour (or member) of the enclosing object.
+		// stops as soon as no preceding object reaches the address, which usually is the first step.
+		while(i > 0u && std::less<const void*>()(byte, reach[i - 1u]))
+		{
+			--i;
+			const node& candidate = graph.m_nodes[by_address[i]];
+			if(std::less<const void*>()(byte, static_cast<const unsigned char*>(candidate.object) + candidate.size))
+				return by_address[i];
+		}
+		return external;
+	};
+
+	graph.m_edges.reserve(holders.size());
+	for(const holder_info& holder : holders)
+	{
+		const std::size_t to = node_indices[holder.dependency];
+		const std::size_t from = containing_node(holder.holder);
+		graph.m_edges.push_back({from, to, holder.holder, holder.file, holder.line});
+		++graph.m_nodes[to].in_degree;
+		if(from != external) ++graph.m_nodes[from].out_degree;
+	}
+	#endif
+	return graph;
+}
+
+inline std::vector<std::vector<std::size_t>> dptr::dependency_graph::cycles() const
+{
+	// iterative tarjan
+	const std::size_t node_count = m_nodes.size();
+	std::vector<std::vector<std::size_t>> successors(node_count);
+	for(const edge& e : m_edges)
+		if(e.from != external) successors[e.from].push_back(e.to);
+
+	std::vector<std::size_t> index(node_count, external), low_link(node_count, 0u);
+	std::vector<bool> on_stack(node_count, false);
+	std::vector<std::size_t> stack;
+	std::vector<std::pair<std::size_t, std::size_t>> call_stack;
+	std::vector<std::vector<std::size_t>> result;
+	std::size_t next_index = 0u;
+	for(std::size_t root = 0u; root < node_count; ++root)
+	{
+		if(index[root] != external) continue;
+		call_stack.push_back({root, 0u});
+		while(!call_stack.empty())
+		{
+			const std::size_t v = call_stack.back().first;
+			std::size_t& next_successor = call_stack.back().second;
+			if(next_successor == 0u && index[v] == external)
+			{
+				index[v] = low_link[v] = next_index++;
+				stack.push_back(v);
+				on_stack[v] = true;
+			}
+			if(next_successor < successors[v].size())
+			{
+				const std::size_t w = successors[v][next_successor++];
+				if(index[w] == external)
+					call_stack.push_back({w, 0u});
+				else if(on_stack[w])
+					low_link[v] = std::min(low_link[v], index[w]);
+				continue;
+			}
+			if(low_link[v] == index[v])
+			{
+				std::vector<std::size_t> component;
+				std::size_t w;
+				do
+				{
+					w = stack.back();
+					stack.pop_back();
+					on_stack[w] = false;
+					component.push_back(w);
+				} while(w != v);
+				const bool self_reference = std::find(successors[v].begin(), successors[v].end(), v) != successors[v].end();
+				if(component.size() > 1u || self_reference)
+					result.push_back(std::move(component));
+			}
+			call_stack.pop_back();
+			if(!call_stack.empty())
+			{
+				const std::size_t parent = call_stack.back().first;
+				low_link[parent] = std::min(low_link[parent], low_link[v]);
+			}
+		}
+	}
+	return result;
+}
+
+inline std::vector<std::size_t> dptr::dependency_graph::teardown_order() const
+{
+	const std::size_t node_count = m_nodes.size();
+	std::vector<std::vector<std::size_t>> successors(node_count);
+	std::vector<std::size_t> internal_in_degree(node_count, 0u);
+	for(const edge& e : m_edges)
+	{
+		if(e.from == external) continue;
+		successors[e.from].push_back(e.to);
+		++internal_in_degree[e.to];
+	}
+	std::vector<std::size_t> order;
+	order.reserve(node_count);
+	for(std::size_t i = 0u; i < node_count; ++i)
+		if(internal_in_degree[i] == 0u) order.push_back(i);
+	for(std::size_t i = 0u; i < order.size(); ++i)
+		for(const std::size_t successor : successors[order[i]])
+			if(--internal_in_degree[successor] == 0u) order.push_back(successor);
+	for(std::size_t i = 0u; i < node_count; ++i)
+		if(internal_in_degree[i] != 0u) order.push_back(i);
+	return order;
+}
+
+inline void dptr::dependency_graph::write_dot(std::ostream& stream) const
+{
+	stream << "digraph dependencies {\n\tnode [shape=box];\n";
+	bool has_external = false;
+	for(std::size_t i = 0u; i < m_nodes.size(); ++i)
+	{
+		const node& n = m_nodes[i];
+		stream << "\tn" << i << " [label=\"";
+		for(const char c : n.type_name) stream << (c == '"' ? '\'' : c);
+		stream << "\\n" << n.object << "\\nin " << n.in_degree << " / out " << n.out_degree << "\"];\n";
+	}
+	for(const edge& e : m_edges)
+	{
+		stream << '\t';
+		if(e.from == external)
+		{
+			stream << "external";
+			has_external = true;
+		}
+		else
+			stream << 'n' << e.from;
+		stream << " -> n" << e.to;
+		if(e.file) stream << " [tooltip=\"" << e.file << ':' << e.line << "\"]";
+		stream << ";\n";
+	}
+	if(has_external) stream << "\texternal [shape=ellipse, style=dashed];\n";
+	stream << "}\n";
+}
+
+inline void dptr::dependency_graph::write_json(std::ostream& stream) const
+{
+	std::size_t external_edges = 0u, max_in_degree = 0u, max_out_degree = 0u;
+	for(const edge& e : m_edges)
+		if(e.from == external) ++external_edges;
+	for(const node& n : m_nodes)
+	{
+		max_in_degree = std::max(max_in_degree, n.in_degree);
+		max_out_degree = std::max(max_out_degree, n.out_degree);
+	}
+	const auto found_cycles = cycles();
+
+	stream << "{\n\t\"nodes\": [";
+	for(std::size_t i = 0u; i < m_nodes.size(); ++i)
+	{
+		const node& n = m_nodes[i];
+		stream << (i ? ",\n\t\t" : "\n\t\t") << "{\"id\": " << i << ", \"address\": \"" << n.object << "\", \"size\": " << n.size << ", \"type\": ";
+		detail::write_json_string(stream, n.type_name);
+		stream << ", \"in_degree\": " << n.in_degree << ", \"out_degree\": " << n.out_degree << '}';
+	}
+	stream << "\n\t],\n\t\"edges\": [";
+	for(std::size_t i = 0u; i < m_edges.size(); ++i)
+	{
+		const edge& e = m_edges[i];
+		stream << (i ? ",\n\t\t" : "\n\t\t") << "{\"from\": ";
+		if(e.from == external) stream << "null";
+		else stream << e.from;
+		stream << ", \"to\": " << e.to << ", \"holder\": \"" << e.holder << "\", \"site\": ";
+		if(e.file)
+		{
+			detail::write_json_string(stream, std::string(e.file) + ':' + std::to_string(e.line));
+		}
+		else
+			stream << "null";
+		stream << '}';
+	}
+	stream << "\n\t],\n\t\"cycles\": [";
+	for(std::size_t i = 0u; i < found_cycles.size(); ++i)
+	{
+		stream << (i ? ", [" : "[");
+		for(std::size_t j = 0u; j < found_cycles[i].size(); ++j)
+			stream << (j ? ", " : "") << found_cycles[i][j];
+		stream << ']';
+	}
+	stream << "],\n\t\"statistics\": {\"nodes\": " << m_nodes.size() << ", \"edges\": " << m_edges.size() << ", \"external_edges\": " << external_edges
+		<< ", \"max_in_degree\": " << max_in_degree << ", \"max_out_degree\": " << max_out_degree << ", \"cycles\": " << found_cycles.size() << "}\n}\n";
+}
+#pragma endregion
+#endif
@@ -0,0 +1,352 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_DEPENDENCY_HANDLE_H_
+#define _DPTR_DEPENDENCY_HANDLE_H_
+
+#include "dependency_ptr.hpp"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace dptr
+{
+	template <typename T, bool atomic = false>
+	class slot_map;
+
+	// Generational handle to an element of a slot_map. Unlike dependency_ptr, a handle can be checked for validity in release builds:
+	// erasing the element increments the generation of its slot, so stale handles compare unequal and get() returns nullptr.
+	// operator-> and operator* assert validity in all builds. The handle references the map with a dependency_ptr, so destroying
+	// the map while handles exist is detected in checked builds.
+	template <typename T, bool atomic = false>
+	class dependency_handle
+	{
+		friend class slot_map<T, atomic>;
+	public:
+		using element_type = T;
+		using map_type = slot_map<T, atomic>;
+
+		dependency_handle() noexcept = default;
+
+		// nullptr if the handle is empty or the element was erased
+		T* get() const noexcept;
+		bool valid() const noexcept;
+		explicit operator bool() const noexcept;
+		T& operator*() const noexcept;
+		T* operator->() const noexcept;
+		void reset() noexcept;
+
+		const map_type* map() const noexcept;
+		bool operator==(const dependency_handle& rhs) const noexcept;
+		bool operator!=(const dependency_handle& rhs) const noexcept;
+	private:
+		dependency_handle(const map_type* map, std::uint32_t slot, std::uint32_t generation) noexcept;
+		dependency_ptr<const map_type> m_map = nullptr;
+		std::uint32_t m_slot = 0u;
+		std::uint32_t m_generation = 0u;
+	};
+
+	// Contiguous storage of T addressed by generational handles. Elements are densely packed (erasing moves the last element
+	// into the gap), so iterating over them is as cache friendly as iterating over a std::vector. Slots are stored as separate
+	// arrays of generations and dense indices (SoA), so a validity check touches one 4 byte generation.
+	// Insertion and erasure are O(1). Erased slots are reused with the next generation, a slot whose generation would wrap around is retired.
+	// If T derives guarded_dependency, dependency_ptrs to elements are checked as usual when elements are moved or erased.
+	// The map can neither be copied nor moved, handles reference it by address.
+	template <typename T, bool atomic>
+	class slot_map : public guarded_dependency<atomic, dependency_op::destroy | dependency_op::move_from | dependency_op::assign>
+	{
+		friend class dependency_handle<T, atomic>;
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using handle = dependency_handle<T, atomic>;
+		using iterator = T*;
+		using const_iterator = const T*;
+
+		slot_map() = default;
+		slot_map(const slot_map&) = delete;
+		slot_map& operator=(const slot_map&) = delete;
+
+		template <typename... args_t>
+		handle emplace(args_t&&... args);
+		handle insert(const T& value);
+		handle insert(T&& value);
+		// returns false if the handle was stale (or belongs to another map)
+		bool erase(const handle& h);
+		// invalidates all handles
+		void clear() noexcept;
+		void reserve(size_type capacity);
+
+		T* get(const handle& h) const noexcept;
+		bool contains(const handle& h) const noexcept;
+		// handle of the element at dense index pos (e.g. while iterating)
+		handle handle_of(size_type pos) const noexcept;
+
+		T* data() noexcept;
+		const T* data() const noexcept;
+		iterator begin() noexcept;
+		iterator end() noexcept;
+		const_iterator begin() const noexcept;
+		const_iterator end() const noexcept;
+		size_type size() const noexcept;
+		bool empty() const noexcept;
+	private:
+		static constexpr std::uint32_t no_slot = std::numeric_limits<std::uint32_t>::max();
+		std::uint32_t acquire_slot();
+
+		// dense element storage and the slot of each element
+		std::vector<T> m_values;
+		std::vector<std::uint32_t> m_value_slots;
+		// per slot: generation and dense index (or next free slot)
+		std::vector<std::uint32_t> m_generations;
+		std::vector<std::uint32_t> m_indices;
+		std::uint32_t m_free_head = no_slot;
+	};
+}
+
+#pragma region implementation
+// --- dependency_handle
+template <typename T, bool atomic>
+inline dptr::dependency_handle<T, atomic>::dependency_handle(const map_type* map, std::uint32_t slot, std::uint32_t generation) noexcept :
+	m_map(map),
+	m_slot(slot),
+	m_generation(generation)
+{
+}
+template <typename T, bool atomic>
+inline T* dptr::dependency_handle<T, atomic>::get() const noexcept
+{
+	const map_type* const map = m_map;
+	return map ? map->get(*this) : nullptr;
+}
+template <typename T, bool atomic>
+inline bool dptr::dependency_handle<T, atomic>::valid() const noexcept
+{
+	const map_type* const map = m_map;
+	return map && map->contains(*this);
+}
+template <typename T, bool atomic>
+inline dptr::dependency_handle<T, atomic>::operator bool() const noexcept
+{
+	return valid();
+}
+template <typename T, bool atomic>
+inline T& dptr::dependency_handle<T, atomic>::operator*() const noexcept
+{
+	T* const ptr = get();
+	DPTR_ASSERT(ptr, "[dptr::dependency_handle::operator*]: The handle is empty or its element was erased.");
+	return *ptr;
+}
+template <typename T, bool atomic>
+inline T* dptr::dependency_handle<T, atomic>::operator->() const noexcept
+{
+	T* const ptr = get();
+	DPTR_ASSERT(ptr, "[dptr::dependency_handle::operator->]: The handle is empty or its element was erased.");
+	return ptr;
+}
+template <typename T, bool atomic>
+inline void dptr::dependency_handle<T, atomic>::reset() noexcept
+{
+	m_map = nullptr;
+	m_slot = 0u;
+	m_generation = 0u;
+}
+template <typename T, bool atomic>
+inline const typename dptr::dependency_handle<T, atomic>::map_type* dptr::dependency_handle<T, atomic>::map() const noexcept
+{
+	return m_map;
+}
+template <typename T, bool atomic>
+inline bool dptr::dependency_handle<T, atomic>::operator==(const dependency_handle& rhs) const noexcept
+{
+	return static_cast<const map_type*>(m_map) == static_cast<const map_type*>(rhs.m_map) && m_slot == rhs.m_slot && m_generation == rhs.m_generation;
+}
+template <typename T, bool atomic>
+inline bool dptr::dependency_handle<T, atomic>::operator!=(const dependency_handle& rhs) const noexcept
+{
+	return !(*this == rhs);
+}
+
+// --- slot_map
+template <typename T, bool atomic>
+template <typename... args_t>
+inline typename dptr::slot_map<T, atomic>::handle dptr::slot_map<T, atomic>::emplace(args_t&&... args)
+{
+	const std::uint32_t slot = acquire_slot();
+	try
+	{
+		m_values.emplace_back(std::forward<args_t>(args)...);
+		m_value_slots.push_back(slot);
+	}
+	catch(...)
+	{
+		if(m_values.size() > m_value_slots.size()) m_values.pop_back();
+		m_indices[slot] = m_free_head;
+		m_free_head = slot;
+		throw;
+	}
+	m_indices[slot] = static_cast<std::uint32_t>(m_values.size() - 1u);
+	return handle(this, slot, m_generations[slot]);
+}
+template <typename T, bool atomic>
+inline typename dptr::slot_map<T, atomic>::handle dptr::slot_map<T, atomic>::insert(const T& value)
+{
+	return emplace(value);
+}
+template <typename T, bool atomic>
+inline typename dptr::slot_map<T, atomic>::handle dptr::slot_map<T, atomic>::insert(T&& value)
+{
+	return emplace(std::move(value));
+}
+template <typename T, bool atomic>
+inline bool dptr::slot_map<T, atomic>::erase(const handle& h)
+{
+	if(!contains(h)) return false;
+	const std::uint32_t index = m_indices[h.m_slot];
+	const std::uint32_t last = static_cast<std::uint32_t>(m_values.size() - 1u);
+	if(index != last)
+	{
+		// fill the gap with the last element
+		m_values[index] = std::move(m_values[last]);
+		m_value_slots[index] = m_value_slots[last];
+		m_indices[m_value_slots[index]] = index;
+	}
+	m_values.pop_back();
+	m_value_slots.pop_back();
+	// retire the slot instead of reusing a generation
+	if(++m_generations[h.m_slot] != 0u)
+	{
+		m_indices[h.m_slot] = m_free_head;
+		m_free_head = h.m_slot;
+	}
+	return true;
+}
+template <typename T, bool atomic>
+inline void dptr::slot_map<T, atomic>::clear() noexcept
+{
+	for(const std::uint32_t slot : m_value_slots)
+	{
+		if(++m_generations[slot] != 0u)
+		{
+			m_indices[slot] = m_free_head;
+			m_free_head = slot;
+		}
+	}
+	m_values.clear();
+	m_value_slots.clear();
+}
+template <typename T, bool atomic>
+inline void dptr::slot_map<T, atomic>::reserve(size_type capacity)
+{
+	m_values.reserve(capacity);
+	m_value_slots.reserve(capacity);
+	m_generations.reserve(capacity);
+	m_indices.reserve(capacity);
+}
+template <typename T, bool atomic>
+inline T* dptr::slot_map<T, atomic>::get(const handle& h) const noexcept
+{
+	if(!contains(h)) return nullptr;
+	return const_cast<T*>(m_values.data()) + m_indices[h.m_slot];
+}
+template <typename T, bool atomic>
+inline bool dptr::slot_map<T, atomic>::contains(const handle& h) const noexcept
+{
+	// generations start at 1, so default constructed handles are never valid
+	return static_cast<const slot_map*>(h.m_map) == this && h.m_slot < m_generations.size() && m_generations[h.m_slot] == h.m_generation;
+}
+template <typename T, bool atomic>
+inline typename dptr::slot_map<T, atomic>::handle dptr::slot_map<T, atomic>::handle_of(size_type pos) const noexcept
+{
+	DPTR_ASSERT(pos < m_values.size(), "[dptr::slot_map::handle_of]: Index out of range.");
+	const std::uint32_t slot = m_value_slots[pos];
+	return handle(this, slot, m_generations[slot]);
+}
+template <typename T, bool atomic>
+inline std::uint32_t dptr::slot_map<T, atomic>::acquire_slot()
+{
+	if(m_free_head != no_slot)
+	{
+		const std::uint32_t slot = m_free_head;
+		m_free_head = m_indices[slot];
+		return slot;
+	}
+	DPTR_ASSERT(m_generations.size() < no_slot, "[dptr::slot_map::acquire_slot]: Too many slots.");
+	m_generations.push_back(1u);
+	try
+	{
+		m_indices.push_back(no_slot);
+	}
+	catch(...)
+	{
+		m_generations.pop_back();
+		throw;
+	}
+	return static_cast<std::uint32_t>(m_generations.size() - 1u);
+}
+template <typename T, bool atomic>
+inline T* dptr::slot_map<T, atomic>::data() noexcept
+{
+	return m_values.data();
+}
+template <typename T, bool atomic>
+inline const T* dptr::slot_map<T, atomic>::data() const noexcept
+{
+	return m_values.data();
+}
+template <typename T, bool atomic>
+inline typename dptr::slot_map<T, atomic>::iterator dptr::slot_map<T, atomic>::begin() noexcept
+{
+	return m_values.data();
+}
+template <typename T, bool atomic>
+inline typename dptr::slot_map<T, atomic>::iterator dptr::slot_map<T, atomic>::end() noexcept
+{
+	return m_values.data() + m_values.size();
+}
+template <typename T, bool atomic>
+inline typename dptr::slot_map<T, atomic>::const_iterator dptr::slot_map<T, atomic>::begin() const noexcept
+{
+	return m_values.data();
+}
+template <typename T, bool atomic>
+inline typename dptr::slot_map<T, atomic>::const_iterator dptr::slot_map<T, atomic>::end() const noexcept
+{
+	return m_values.data() + m_values.size();
+}
+template <typename T, bool atomic>
+inline typename dptr::slot_map<T, atomic>::size_type dptr::slot_map<T, atomic>::size() const noexcept
+{
+	return m_values.size();
+}
+template <typename T, bool atomic>
+inline bool dptr::slot_map<T, atomic>::empty() const noexcept
+{
+	return m_values.empty();
+}
+#pragma endregion
+#endif
@@ -32,18 +32,103 @@
 #include <ostream>
 #include <utility>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
 
+// --- check modes
+// DPTR_CHECK_MODE_OFF:     dependency_ptr<T> is a plain T*, guarded_dependency is empty.
+// DPTR_CHECK_MODE_SAMPLED: like full checks, but only a sampled fraction of guarded dependencies counts references (see dptr::set_sampling_rate).
+// DPTR_CHECK_MODE_FULL:    every guarded dependency counts references.
+// Defaults to DPTR_CHECK_MODE_OFF if NDEBUG is defined and to DPTR_CHECK_MODE_FULL otherwise.
+// Must be the same in all translation units. Can be overridden per type via dptr::dependency_check_mode.
+#define DPTR_CHECK_MODE_OFF 0
+#define DPTR_CHECK_MODE_SAMPLED 1
+#define DPTR_CHECK_MODE_FULL 2
+#ifndef DPTR_CHECK_MODE
+#ifdef NDEBUG
+#define DPTR_CHECK_MODE DPTR_CHECK_MODE_OFF
+#else
+#define DPTR_CHECK_MODE DPTR_CHECK_MODE_FULL
+#endif
+#endif
+#if DPTR_CHECK_MODE != DPTR_CHECK_MODE_OFF && DPTR_CHECK_MODE != DPTR_CHECK_MODE_SAMPLED && DPTR_CHECK_MODE != DPTR_CHECK_MODE_FULL
+#error "[dptr]: DPTR_CHECK_MODE must be one of DPTR_CHECK_MODE_OFF, DPTR_CHECK_MODE_SAMPLED or DPTR_CHECK_MODE_FULL."
+#endif
+
+// one out of DPTR_SAMPLING_RATE guarded dependencies is checked in DPTR_CHECK_MODE_SAMPLED (initial value, can be changed at runtime)
+#ifndef DPTR_SAMPLING_RATE
+#define DPTR_SAMPLING_RATE 64
+#endif
+
+// opt-in registry of all live dependency_ptrs (address, acquisition site and thread) in checked builds.
+// failed assertions on a guarded dependency then list the dependency_ptrs still referencing it.
+// must be the same in all translation units.
+#ifndef DPTR_TRACK_HOLDERS
+#define DPTR_TRACK_HOLDERS 0
+#endif
+#if DPTR_TRACK_HOLDERS
+#include <mutex>
+#include <thread>
+#include <typeinfo>
+#endif
+
+// opt-in per-type reference count statistics (add_ref/release counts, peak references, contended updates) in checked builds.
+// aggregated thread locally, see dptr::dump_stats. must be the same in all translation units.
+#ifndef DPTR_COLLECT_STATS
+#define DPTR_COLLECT_STATS 0
+#endif
+
+// number of independently locked shards of the side table (power of two), see dptr::side_table_dependency
+#ifndef DPTR_SIDE_TABLE_SHARDS
+#define DPTR_SIDE_TABLE_SHARDS 64
+#endif
+#if DPTR_COLLECT_STATS
+#include <mutex>
+#include <typeinfo>
+#endif
+
+// --- constexpr support (C++20): dependency_ptr and guarded dependencies with default_counter<false> can be constructed, copied and
+// destroyed in constant expressions, so that violations of a statically wired object graph are compile errors.
+// Not available with DPTR_TRACK_HOLDERS, whose registry cannot be used at compile time, and GCC < 13, which rejects the (mutable) reference counters in constant expressions.
+#if ((defined(_MSVC_LANG) && _MSVC_LANG >= 202002L) || __cplusplus >= 202002L) && defined(__cpp_constexpr_dynamic_alloc) && defined(__cpp_lib_is_constant_evaluated) && !DPTR_TRACK_HOLDERS &&\
+	(defined(__clang__) || !defined(__GNUC__) || __GNUC__ >= 13)
+#define DPTR_CONSTEXPR constexpr
+#define DPTR_HAS_CONSTEXPR 1
+#else
+#define DPTR_CONSTEXPR
+#define DPTR_HAS_CONSTEXPR 0
+#endif
+
+// --- violation handling
+// Failed checks are reported to a violation handler (see dptr::violation). By default, the handler can be replaced at runtime
+// (dptr::set_violation_handler) and the default handler prints to std::cerr and aborts, which requires <iostream>.
+// Defining DPTR_VIOLATION_HANDLER as the name of a function void(const dptr::violation&) calls it directly instead, and <iostream> is not included.
+// The function has to be declared before this header is included (dptr::violation can be forward declared).
+// If the handler returns, execution continues after the failed check. Must be the same in all translation units.
+#ifndef DPTR_VIOLATION_HANDLER
 #include <iostream>
-#ifndef NDEBUG
-#define DPTR_ASSERT(condition, message)\
-	(!(condition) ?\
-		(std::cerr << "Assertion failed: (" << #condition << ")" << std::endl <<\
-		"\tfile: " << __FILE__ << std::endl <<\
-		"\tline: " << __LINE__ << std::endl <<\
-		"\tmessage:" << message << std::endl, std::abort()) : (void)0)
+// default stream of print_holders and dump_stats
+#define DPTR_DEFAULT_OSTREAM = std::cerr
 #else
-#define DPTR_ASSERT(condition, message) 0
+#define DPTR_DEFAULT_OSTREAM
 #endif
+#include <cstdlib>
+
+// DPTR_ASSERT is checked in all builds. It is used by the checked implementations, which are never instantiated for unchecked types,
+// and for the few checks that have to hold in every build (e.g. offsets that do not fit into a relative pointer).
+#define DPTR_REPORT_VIOLATION(op, dependency, count, condition, message)\
+	::dptr::detail::report_violation(::dptr::violation{static_cast<::dptr::dependency_op_flags>(op), dependency, count, condition, message, __FILE__, __LINE__})
+#define DPTR_ASSERT(condition, message)\
+	(!(condition) ?\
+		DPTR_REPORT_VIOLATION(0u, nullptr, 0u, #condition, message) : (void)0)
+// checks a precondition (nullptr access, index range) of an implementation that also exists in unchecked builds.
+// compiled out unless checked (a constant expression, usually whether the implementation is counted) is true.
+#define DPTR_PRECONDITION(checked, condition, message)\
+	do { if constexpr(checked) DPTR_ASSERT(condition, message); } while(false)
+// reports a violation of the forbidden operation op if count (reference count of dependency) is not 0. count is evaluated once.
+#define DPTR_ASSERT_UNREFERENCED(op, count, dependency, message)\
+	::dptr::detail::check_unreferenced(static_cast<::dptr::dependency_op_flags>(op), count, dependency, #count " == 0", message, __FILE__, __LINE__)
 
 namespace dptr
 {
@@ -72,15 +157,206 @@ namespace dptr
 	constexpr dependency_op_flags& operator&=(dependency_op_flags& lhs, dependency_op rhs) noexcept;
 	constexpr dependency_op_flags& operator^=(dependency_op_flags& lhs, dependency_op rhs) noexcept;
 
+	// --- failed check as passed to the violation handler
+	struct violation
+	{
+		// the forbidden operation (dependency_op flags), 0 for checks which are not about an operation on a dependency (e.g. nullptr access)
+		dependency_op_flags op;
+		// address of the referenced dependency (see print_holders) and its reference count, nullptr and 0 if not applicable
+		const void* dependency;
+		std::size_t count;
+		const char* condition;
+		const char* message;
+		const char* file;
+		unsigned line;
+		// index of the referenced element in its container (guarded_vector), no_index for other dependencies
+		static constexpr std::size_t no_index = static_cast<std::size_t>(-1);
+		std::size_t index = no_index;
+	};
+	using violation_handler = void (*)(const violation&);
+	#ifndef DPTR_VIOLATION_HANDLER
+	// replaces the violation handler, nullptr restores default_violation_handler. returns the previous handler.
+	// a handler which returns (e.g. logs the violation in canary builds) lets the program continue, which may be undefined behaviour
+	// for violations of forbidden operations. handlers must not throw.
+	violation_handler set_violation_handler(violation_handler handler) noexcept;
+	violation_handler get_violation_handler() noexcept;
+	// prints the violation (and the holders of the dependency with DPTR_TRACK_HOLDERS) to std::cerr and aborts
+	[[noreturn]] void default_violation_handler(const violation& v) noexcept;
+	#endif
+
+	// --- check mode of a dependency type, see DPTR_CHECK_MODE
+	enum class check_mode : std::uint8_t
+	{
+		off = DPTR_CHECK_MODE_OFF,
+		sampled = DPTR_CHECK_MODE_SAMPLED,
+		full = DPTR_CHECK_MODE_FULL
+	};
+	constexpr check_mode default_check_mode = static_cast<check_mode>(DPTR_CHECK_MODE);
+
+	// Per-type check mode used by dependency_ptr<T> (and guarded_dependency_for<T>). Specialize it (or use DPTR_DEPENDENCY_CHECK_MODE)
+	// in the header declaring T, before T is defined or any dependency_ptr<T> is used, like any other trait specialization.
+	template <typename T>
+	struct dependency_check_mode : std::integral_constant<check_mode, default_check_mode> {};
+	template <typename T>
+	constexpr check_mode dependency_check_mode_v = dependency_check_mode<std::remove_cv_t<T>>::value;
+
+	// Types which cannot derive from guarded_dependency (third-party types, types with a fixed layout) can be tracked by
+	// specializing this trait (or using DPTR_SIDE_TABLE_DEPENDENCY). Their reference counts are stored in a global table
+	// keyed by address, so sizeof(T) does not change. Forbidden operations cannot be detected automatically, see assert_unreferenced.
+	template <typename T>
+	struct side_table_dependency : std::false_type {};
+	template <typename T>
+	constexpr bool side_table_dependency_v = side_table_dependency<std::remove_cv_t<T>>::value;
+
+	// --- reference counter policies for guarded_dependency.
+	// A counter policy is default constructible (count = 0) and provides inc(), dec() and load().
+	// is_atomic tells whether inc() and dec() may be called concurrently.
+	// Optionally, try_inc() and try_dec() make a single update attempt and return false if it failed because of contention
+	// (used by DPTR_COLLECT_STATS to count contended updates).
+	#ifndef DPTR_CACHE_LINE_SIZE
+	#define DPTR_CACHE_LINE_SIZE 64
+	#endif
+
+	// single counter. atomic variant uses relaxed fetch_add / fetch_sub.
+	template <bool atomic>
+	class default_counter;
+	template <>
+	class default_counter<true>
+	{
+	public:
+		static constexpr bool is_atomic = true;
+		default_counter() noexcept;
+		default_counter(const default_counter&) = delete;
+		default_counter& operator=(const default_counter&) = delete;
+		void inc() noexcept;
+		void dec() noexcept;
+		bool try_inc() noexcept;
+		bool try_dec() noexcept;
+		std::size_t load() const noexcept;
+	private:
+		std::atomic<std::size_t> m_count;
+	};
+	template <>
+	class default_counter<false>
+	{
+	public:
+		static constexpr bool is_atomic = false;
+		DPTR_CONSTEXPR default_counter() noexcept;
+		default_counter(const default_counter&) = delete;
+		default_counter& operator=(const default_counter&) = delete;
+		DPTR_CONSTEXPR void inc() noexcept;
+		DPTR_CONSTEXPR void dec() noexcept;
+		DPTR_CONSTEXPR std::size_t load() const noexcept;
+	private:
+		std::size_t m_count;
+	};
+
+	// Counter split into shard_count cache-line-sized shards. Each thread increments and decrements the shard
+	// it is assigned to, so threads copying pointers to the same dependency do not fight over one cache line.
+	// load() sums up all shards and is only called when a forbidden operation is checked.
+	// Shards of a single thread may wrap around (released on another thread), the modular sum stays correct.
+	// Costs shard_count * DPTR_CACHE_LINE_SIZE bytes per dependency, so use it for heavily shared objects only.
+	template <std::size_t shard_count = 16>
+	class sharded_counter
+	{
+		static_assert(shard_count > 0u && (shard_count & (shard_count - 1u)) == 0u, "[dptr::sharded_counter]: shard_count must be a power of two.");
+	public:
+		static constexpr bool is_atomic = true;
+		sharded_counter() noexcept;
+		sharded_counter(const sharded_counter&) = delete;
+		sharded_counter& operator=(const sharded_counter&) = delete;
+		void inc() noexcept;
+		void dec() noexcept;
+		std::size_t load() const noexcept;
+	private:
+		struct alignas(DPTR_CACHE_LINE_SIZE) shard
+		{
+			std::atomic<std::size_t> count;
+		};
+		shard m_shards[shard_count];
+	};
+
+	// Counter stored as count_type (std::uint16_t, std::uint32_t, ...) to reduce the overhead of many small dependencies.
+	// Exceeding the maximum count triggers an assertion (after the atomic counter already wrapped around).
+	template <bool atomic, typename count_type = std::uint32_t>
+	class compact_counter
+	{
+		static_assert(std::is_unsigned_v<count_type>, "[dptr::compact_counter]: count_type must be an unsigned integer type.");
+	public:
+		static constexpr bool is_atomic = atomic;
+		compact_counter() noexcept;
+		compact_counter(const compact_counter&) = delete;
+		compact_counter& operator=(const compact_counter&) = delete;
+		void inc() noexcept;
+		void dec() noexcept;
+		std::size_t load() const noexcept;
+	private:
+		std::conditional_t<atomic, std::atomic<count_type>, count_type> m_count;
+	};
+
+	// Places another counter policy on its own cache line, so that reference count updates by other threads do not
+	// slow down reads of the neighbouring members of the dependency (false sharing). Aligns the dependency to DPTR_CACHE_LINE_SIZE,
+	// i.e. costs up to DPTR_CACHE_LINE_SIZE bytes per object.
+	template <typename counter_policy = default_counter<true>>
+	class alignas(DPTR_CACHE_LINE_SIZE) isolated_counter
+	{
+	public:
+		static constexpr bool is_atomic = counter_policy::is_atomic;
+		isolated_counter() noexcept = default;
+		isolated_counter(const isolated_counter&) = delete;
+		isolated_counter& operator=(const isolated_counter&) = delete;
+		void inc() noexcept;
+		void dec() noexcept;
+		std::size_t load() const noexcept;
+	private:
+		counter_policy m_counter;
+	};
+
+	// Wraps another counter policy and only counts references to a sampled fraction of objects.
+	// Whether an object is sampled is decided once on construction (see set_sampling_rate).
+	// References to objects that are not sampled cost a load and a branch.
+	template <typename counter_policy>
+	class sampled_counter
+	{
+	public:
+		static constexpr bool is_atomic = counter_policy::is_atomic;
+		sampled_counter() noexcept;
+		sampled_counter(const sampled_counter&) = delete;
+		sampled_counter& operator=(const sampled_counter&) = delete;
+		void inc() noexcept;
+		void dec() noexcept;
+		std::size_t load() const noexcept;
+		bool sampled() const noexcept;
+	private:
+		counter_policy m_counter;
+		const bool m_sampled;
+	};
+
+	// one out of rate objects using sampled_counter is sampled. 0 disables sampling, 1 samples every object.
+	// only affects objects constructed afterwards.
+	void set_sampling_rate(std::uint32_t rate) noexcept;
+	std::uint32_t sampling_rate() noexcept;
+
 	namespace detail
 	{
-		#ifdef NDEBUG
-		template <typename debug_type, typename release_type>
-		using debug_type_choice_t = release_type;
-		#else
-		template <typename debug_type, typename release_type>
-		using debug_type_choice_t = debug_type;
-		#endif
+		template <dptr::check_mode mode, typename checked_type, typename unchecked_type>
+		using check_mode_choice_t = std::conditional_t<mode == dptr::check_mode::off, unchecked_type, checked_type>;
+
+		// counter policy actually used by a guarded_dependency with the given check mode
+		template <dptr::check_mode mode, typename counter_policy>
+		using check_mode_counter_t = std::conditional_t<mode == dptr::check_mode::sampled, dptr::sampled_counter<counter_policy>, counter_policy>;
+
+		// whether a counter policy provides try_inc() and try_dec()
+		template <typename counter_policy, typename = void>
+		struct has_try_update : std::false_type {};
+		template <typename counter_policy>
+		struct has_try_update<counter_policy, std::void_t<decltype(std::declval<counter_policy&>().try_inc()), decltype(std::declval<counter_policy&>().try_dec())>> : std::true_type {};
+
+		// index of the calling thread, assigned round robin on first use
+		std::size_t this_thread_index() noexcept;
+		// returns true for one out of sampling_rate() calls (per thread, pseudo random)
+		bool sample() noexcept;
+		std::atomic<std::uint32_t>& sampling_rate_storage() noexcept;
 
 		#pragma region intrusive_ptr
 
@@ -88,67 +364,68 @@ namespace dptr
 		template <typename T>
 		class intrusive_ptr
 		{
+			template <typename U> friend class intrusive_ptr;
 		public:
 			using element_type = T;
 			using pointer = T*;
 			using difference_type = std::ptrdiff_t;
 
-			intrusive_ptr() noexcept;
-			intrusive_ptr(T* ptr, bool add_ref = true);
+			DPTR_CONSTEXPR intrusive_ptr() noexcept;
+			DPTR_CONSTEXPR intrusive_ptr(T* ptr, bool add_ref = true);
 
-			intrusive_ptr(const intrusive_ptr& other);
-			intrusive_ptr& operator=(const intrusive_ptr& other);
-			intrusive_ptr(intrusive_ptr&& other) noexcept;
-			intrusive_ptr& operator=(intrusive_ptr&& other) noexcept;
+			DPTR_CONSTEXPR intrusive_ptr(const intrusive_ptr& other);
+			DPTR_CONSTEXPR intrusive_ptr& operator=(const intrusive_ptr& other);
+			DPTR_CONSTEXPR intrusive_ptr(intrusive_ptr&& other) noexcept;
+			DPTR_CONSTEXPR intrusive_ptr& operator=(intrusive_ptr&& other) noexcept;
 
-			template <typename U> intrusive_ptr(const intrusive_ptr<U>& other);			
-			template <typename U> intrusive_ptr& operator=(const intrusive_ptr<U>& other);			
-			template <typename U> intrusive_ptr(intrusive_ptr<U>&& other) noexcept;			
-			template <typename U> intrusive_ptr& operator=(intrusive_ptr<U>&& other) noexcept;
+			template <typename U> DPTR_CONSTEXPR intrusive_ptr(const intrusive_ptr<U>& other);			
+			template <typename U> DPTR_CONSTEXPR intrusive_ptr& operator=(const intrusive_ptr<U>& other);			
+			template <typename U> DPTR_CONSTEXPR intrusive_ptr(intrusive_ptr<U>&& other) noexcept;			
+			template <typename U> DPTR_CONSTEXPR intrusive_ptr& operator=(intrusive_ptr<U>&& other) noexcept;
 
-			intrusive_ptr& operator=(T* ptr);
+			DPTR_CONSTEXPR intrusive_ptr& operator=(T* ptr);
 
-			void reset();
-			void reset(T* ptr);
-			void reset(T* ptr, bool add_ref);
+			DPTR_CONSTEXPR void reset();
+			DPTR_CONSTEXPR void reset(T* ptr);
+			DPTR_CONSTEXPR void reset(T* ptr, bool add_ref);
 
-			T& operator*() const noexcept;
-			T* operator->() const noexcept;
-			T* get() const noexcept;
-			T* detach() noexcept;
+			DPTR_CONSTEXPR T& operator*() const noexcept;
+			DPTR_CONSTEXPR T* operator->() const noexcept;
+			DPTR_CONSTEXPR T* get() const noexcept;
+			DPTR_CONSTEXPR T* detach() noexcept;
 
-			explicit operator bool() const noexcept;
+			DPTR_CONSTEXPR explicit operator bool() const noexcept;
 
-			void swap(intrusive_ptr& rhs) noexcept;
+			DPTR_CONSTEXPR void swap(intrusive_ptr& rhs) noexcept;
 
-			~intrusive_ptr();
+			DPTR_CONSTEXPR ~intrusive_ptr();
 		private:
 			T* m_ptr;
 		};
 
 		template <typename T, typename U>
-		bool operator==(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept;
+		DPTR_CONSTEXPR bool operator==(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept;
 		template <typename T, typename U>
-		bool operator!=(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept;
+		DPTR_CONSTEXPR bool operator!=(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept;
 		template <typename T, typename U>
-		bool operator==(const intrusive_ptr<T>& lhs, U* rhs) noexcept;
+		DPTR_CONSTEXPR bool operator==(const intrusive_ptr<T>& lhs, U* rhs) noexcept;
 		template <typename T, typename U>
-		bool operator!=(const intrusive_ptr<T>& lhs, U* rhs) noexcept;
+		DPTR_CONSTEXPR bool operator!=(const intrusive_ptr<T>& lhs, U* rhs) noexcept;
 		template <typename T, typename U>
-		bool operator==(U* lhs, const intrusive_ptr<T>& rhs) noexcept;
+		DPTR_CONSTEXPR bool operator==(U* lhs, const intrusive_ptr<T>& rhs) noexcept;
 		template <typename T, typename U>
-		bool operator!=(U* lhs, const intrusive_ptr<T>& rhs) noexcept;
+		DPTR_CONSTEXPR bool operator!=(U* lhs, const intrusive_ptr<T>& rhs) noexcept;
 
 		template <typename T>
-		void swap(intrusive_ptr<T>& lhs, intrusive_ptr<T>& rhs) noexcept;
+		DPTR_CONSTEXPR void swap(intrusive_ptr<T>& lhs, intrusive_ptr<T>& rhs) noexcept;
 		template <typename T>
 		T* get_pointer(const intrusive_ptr<T>& iptr) noexcept;
 		template <typename T, typename U>
-		intrusive_ptr<T> static_pointer_cast(const intrusive_ptr<U>& iptr) noexcept;
+		DPTR_CONSTEXPR intrusive_ptr<T> static_pointer_cast(const intrusive_ptr<U>& iptr) noexcept;
 		template <typename T, typename U>
-		intrusive_ptr<T> const_pointer_cast(const intrusive_ptr<U>& iptr) noexcept;
+		DPTR_CONSTEXPR intrusive_ptr<T> const_pointer_cast(const intrusive_ptr<U>& iptr) noexcept;
 		template <typename T, typename U>
-		intrusive_ptr<T> dynamic_pointer_cast(const intrusive_ptr<U>& iptr) noexcept;
+		DPTR_CONSTEXPR intrusive_ptr<T> dynamic_pointer_cast(const intrusive_ptr<U>& iptr) noexcept;
 		template <typename Elem, typename Traits, typename T>
 		std::basic_ostream<Elem, Traits>& operator<<(std::basic_ostream<Elem, Traits>&, const intrusive_ptr<T>& iptr);
 
@@ -156,65 +433,54 @@ namespace dptr
 
 		#pragma region guarded_dependency
 		// --- empty dummy class for release. should enable empty base optimization
-		template <bool atomic = false, dptr::dependency_op_flags forbidden_ops = dependency_op::destroy | dependency_op::move_from | dependency_op::assign>
+		template <bool atomic = false, dptr::dependency_op_flags forbidden_ops = dependency_op::destroy | dependency_op::move_from | dependency_op::assign, typename counter_policy = dptr::default_counter<atomic>>
 		class guarded_dependency_nop
 		{
 			static constexpr bool is_dep_ref_counter_atomic = atomic;
 			static constexpr dptr::dependency_op_flags dep_forbidden_op_flags = forbidden_ops;
+			using dep_ref_counter_type = counter_policy;
 		};
 
 		// --- implemented variant for debug
-		template <bool atomic = false, dptr::dependency_op_flags forbidden_ops = dependency_op::destroy | dependency_op::move_from | dependency_op::assign>
+		template <bool atomic = false, dptr::dependency_op_flags forbidden_ops = dependency_op::destroy | dependency_op::move_from | dependency_op::assign, typename counter_policy = dptr::default_counter<atomic>>
 		class guarded_dependency_impl;
 		
-		template<bool atomic, dptr::dependency_op_flags forbidden_ops>
-		void intrusive_ptr_add_ref(const guarded_dependency_impl<atomic, forbidden_ops>* dep) noexcept;
-		template<bool atomic, dptr::dependency_op_flags forbidden_ops>
-		void intrusive_ptr_release(const guarded_dependency_impl<atomic, forbidden_ops>* dep) noexcept;
+		// take the dependency type itself (not its guarded_dependency_impl base), so statistics can be collected per type
+		template <typename T>
+		DPTR_CONSTEXPR void intrusive_ptr_add_ref(const T* dep) noexcept;
+		template <typename T>
+		DPTR_CONSTEXPR void intrusive_ptr_release(const T* dep) noexcept;
+		template <typename T>
+		std::size_t reference_count(const T* dep) noexcept;
 		
-		template<dptr::dependency_op_flags forbidden_ops>
-		class guarded_dependency_impl<true, forbidden_ops>
-		{
-			friend void intrusive_ptr_add_ref<>(const guarded_dependency_impl*) noexcept;
-			friend void intrusive_ptr_release<>(const guarded_dependency_impl*) noexcept;
-		public:
-			static constexpr bool is_dep_ref_counter_atomic = true;
-			static constexpr dptr::dependency_op_flags dep_forbidden_op_flags = forbidden_ops;
-		protected:
-			guarded_dependency_impl() noexcept;
-			guarded_dependency_impl(const guarded_dependency_impl& other) noexcept;
-			guarded_dependency_impl(guarded_dependency_impl&& other) noexcept;
-			guarded_dependency_impl& operator=(const guarded_dependency_impl& other) noexcept;
-			guarded_dependency_impl& operator=(guarded_dependency_impl&& other) noexcept;
-			~guarded_dependency_impl();
-		private:
-			void inc() const noexcept;
-			void dec() const noexcept;
-
-			using counter_t = std::atomic<std::size_t>;
-			mutable counter_t m_counter;
-		};
-		template<dptr::dependency_op_flags forbidden_ops>
-		class guarded_dependency_impl<false, forbidden_ops>
+		template<bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+		class guarded_dependency_impl
 		{
-			friend void intrusive_ptr_add_ref<>(const guarded_dependency_impl*) noexcept;
-			friend void intrusive_ptr_release<>(const guarded_dependency_impl*) noexcept;
+			static_assert(!atomic || counter_policy::is_atomic, "[dptr::detail::guarded_dependency_impl]: atomic guarded dependencies require a thread-safe counter policy.");
+			template <typename T> friend DPTR_CONSTEXPR void intrusive_ptr_add_ref(const T*) noexcept;
+			template <typename T> friend DPTR_CONSTEXPR void intrusive_ptr_release(const T*) noexcept;
+			template <typename T> friend std::size_t reference_count(const T*) noexcept;
 		public:
-			static constexpr bool is_dep_ref_counter_atomic = false;
+			static constexpr bool is_dep_ref_counter_atomic = atomic;
 			static constexpr dptr::dependency_op_flags dep_forbidden_op_flags = forbidden_ops;
+			using dep_ref_counter_type = counter_policy;
 		protected:
-			guarded_dependency_impl() noexcept;
-			guarded_dependency_impl(const guarded_dependency_impl& other) noexcept;
-			guarded_dependency_impl(guarded_dependency_impl&& other) noexcept;
-			guarded_dependency_impl& operator=(const guarded_dependency_impl& other) noexcept;
-			guarded_dependency_impl& operator=(guarded_dependency_impl&& other) noexcept;
-			~guarded_dependency_impl();
+			DPTR_CONSTEXPR guarded_dependency_impl() noexcept;
+			DPTR_CONSTEXPR guarded_dependency_impl(const guarded_dependency_impl& other) noexcept;
+			DPTR_CONSTEXPR guarded_dependency_impl(guarded_dependency_impl&& other) noexcept;
+			DPTR_CONSTEXPR guarded_dependency_impl& operator=(const guarded_dependency_impl& other) noexcept;
+			DPTR_CONSTEXPR guarded_dependency_impl& operator=(guarded_dependency_impl&& other) noexcept;
+			DPTR_CONSTEXPR ~guarded_dependency_impl();
 		private:
-			void inc() const noexcept;
-			void dec() const noexcept;
+			DPTR_CONSTEXPR void inc() const noexcept;
+			DPTR_CONSTEXPR void dec() const noexcept;
+			// single update attempts, false if contended (inc/dec without try_inc/try_dec support never fail)
+			DPTR_CONSTEXPR bool try_inc() const noexcept;
+			DPTR_CONSTEXPR bool try_dec() const noexcept;
+			DPTR_CONSTEXPR std::size_t count() const noexcept;
 
-			using counter_t = std::size_t;
-			mutable counter_t m_counter;
+			// counter policies only expose inc(), dec() and load(). a fresh counter starts at 0.
+			mutable counter_policy m_counter;
 		};
 
 		template <typename T, typename = void>
@@ -225,181 +491,701 @@ namespace dptr
 			std::void_t<
 				std::enable_if_t<std::is_same_v<std::remove_cv_t<decltype(T::is_dep_ref_counter_atomic)>, bool>>,
 				std::enable_if_t<std::is_same_v<std::remove_cv_t<decltype(T::dep_forbidden_op_flags)>, dptr::dependency_op_flags>>,
-				std::enable_if_t<std::is_base_of_v<guarded_dependency_impl<T::is_dep_ref_counter_atomic, T::dep_forbidden_op_flags>, std::remove_cv_t<T>>>
+				std::enable_if_t<std::is_base_of_v<guarded_dependency_impl<T::is_dep_ref_counter_atomic, T::dep_forbidden_op_flags, typename T::dep_ref_counter_type>, std::remove_cv_t<T>>>
 			>
 		> : std::true_type {};		
 		#pragma endregion
 
+		// the guarded_dependency_impl base of a guarded dependency type
+		template <typename T>
+		using guarded_base_t = guarded_dependency_impl<T::is_dep_ref_counter_atomic, T::dep_forbidden_op_flags, typename T::dep_ref_counter_type>;
+
+		#pragma region guarded_arena
+		// --- arena level reference counter. references to all arena dependencies bound to it are counted here.
+		template <bool atomic, typename counter_policy>
+		class guarded_arena_impl
+		{
+			static_assert(!atomic || counter_policy::is_atomic, "[dptr::detail::guarded_arena_impl]: atomic guarded arenas require a thread-safe counter policy.");
+			template <typename T> friend DPTR_CONSTEXPR void intrusive_ptr_add_ref(const T*) noexcept;
+			template <typename T> friend DPTR_CONSTEXPR void intrusive_ptr_release(const T*) noexcept;
+		public:
+			// makes the arena the current arena of the calling thread while it lives. arena dependencies default constructed
+			// on this thread bind to the current arena.
+			class binding
+			{
+			public:
+				explicit binding(const guarded_arena_impl& arena) noexcept;
+				binding(const binding&) = delete;
+				binding& operator=(const binding&) = delete;
+				~binding();
+			private:
+				const guarded_arena_impl* m_previous;
+			};
+
+			guarded_arena_impl() noexcept = default;
+			// arena dependencies point to their arena
+			guarded_arena_impl(const guarded_arena_impl&) = delete;
+			guarded_arena_impl& operator=(const guarded_arena_impl&) = delete;
+			~guarded_arena_impl();
+
+			binding bind() const noexcept;
+			// dependency_ptrs referencing any object of the arena
+			std::size_t references() const noexcept;
+			// O(1) check before resetting or releasing the arena
+			void assert_unreferenced() const noexcept;
+			// nullptr if the calling thread has no current arena of this type
+			static const guarded_arena_impl* current() noexcept;
+		private:
+			static const guarded_arena_impl*& current_storage() noexcept;
+			mutable counter_policy m_counter;
+		};
+
+		// --- base class of objects living in a guarded arena. stores a pointer to its arena instead of a counter.
+		// there are no per-object checks, the arena checks all its objects at once.
+		template <bool atomic, typename counter_policy>
+		class arena_dependency_impl
+		{
+			template <typename T> friend DPTR_CONSTEXPR void intrusive_ptr_add_ref(const T*) noexcept;
+			template <typename T> friend DPTR_CONSTEXPR void intrusive_ptr_release(const T*) noexcept;
+		public:
+			static constexpr bool is_dep_ref_counter_atomic = atomic;
+			using arena_type = guarded_arena_impl<atomic, counter_policy>;
+			using arena_dependency_base = arena_dependency_impl;
+		protected:
+			// binds to the current arena of the calling thread (see guarded_arena::bind)
+			arena_dependency_impl() noexcept;
+			explicit arena_dependency_impl(const arena_type& arena) noexcept;
+			// copies bind to the current arena if there is one, otherwise to the arena of other
+			arena_dependency_impl(const arena_dependency_impl& other) noexcept;
+			// objects stay in their arena when assigned to
+			arena_dependency_impl& operator=(const arena_dependency_impl&) noexcept { return *this; }
+			~arena_dependency_impl() = default;
+		private:
+			const arena_type* m_arena;
+		};
+
+		// --- empty variants for unchecked builds
+		template <bool atomic, typename counter_policy>
+		class guarded_arena_nop
+		{
+		public:
+			class binding
+			{
+			public:
+				explicit binding(const guarded_arena_nop&) noexcept {}
+				binding(const binding&) = delete;
+				binding& operator=(const binding&) = delete;
+			};
+			guarded_arena_nop() noexcept = default;
+			guarded_arena_nop(const guarded_arena_nop&) = delete;
+			guarded_arena_nop& operator=(const guarded_arena_nop&) = delete;
+			binding bind() const noexcept { return binding(*this); }
+			std::size_t references() const noexcept { return 0u; }
+			void assert_unreferenced() const noexcept {}
+		};
+		template <bool atomic, typename counter_policy>
+		class arena_dependency_nop
+		{
+		protected:
+			arena_dependency_nop() noexcept = default;
+			explicit arena_dependency_nop(const guarded_arena_nop<atomic, counter_policy>&) noexcept {}
+		};
+
+		template <typename T, typename = void>
+		struct is_arena_dependency : std::false_type {};
+		template <typename T>
+		struct is_arena_dependency<T, std::enable_if_t<std::is_base_of_v<typename T::arena_dependency_base, std::remove_cv_t<T>>>> : std::true_type {};
+		#pragma endregion
+
+		// T derives (checked) guarded_dependency or arena_dependency or is a side table dependency
+		template <typename T>
+		constexpr bool is_checked_dependency_v = is_guarded_dependency<T>::value || is_arena_dependency<T>::value || dptr::side_table_dependency_v<T>;
+		// whether references to T may be acquired concurrently. side table counters are always thread-safe.
+		template <typename T, typename = void>
+		struct is_ref_counter_atomic : std::true_type {};
+		template <typename T>
+		struct is_ref_counter_atomic<T, std::enable_if_t<is_guarded_dependency<T>::value || is_arena_dependency<T>::value>> : std::bool_constant<T::is_dep_ref_counter_atomic> {};
+		// whether code destroying a T (containers, teardown) has to check its reference count: checked types which do not report
+		// their own destruction. guarded dependencies forbidding destroy do, arena dependencies are checked by their arena.
+		template <typename T, typename = void>
+		struct needs_destroy_check : std::bool_constant<is_checked_dependency_v<T> && !is_arena_dependency<T>::value> {};
+		template <typename T>
+		struct needs_destroy_check<T, std::enable_if_t<is_guarded_dependency<T>::value>> : std::bool_constant<!(T::dep_forbidden_op_flags & dptr::dependency_op::destroy)> {};
+		// address identifying a referenced dependency: its guarded_dependency_impl base or the object itself (side table)
+		template <typename T>
+		const void* dependency_address(const T* ptr) noexcept;
+
+		#pragma region side_table
+		// Reference counts of side table dependencies. Sharded by address, every shard is an open addressing hash table
+		// (linear probing, backward shift deletion) behind its own spin lock. Entries only exist while the count is > 0.
+		class side_table
+		{
+		public:
+			// return the count after the update
+			static std::size_t add_ref(const void* object) noexcept;
+			static std::size_t release(const void* object) noexcept;
+			static std::size_t count(const void* object) noexcept;
+		private:
+			static_assert(DPTR_SIDE_TABLE_SHARDS > 0 && (DPTR_SIDE_TABLE_SHARDS & (DPTR_SIDE_TABLE_SHARDS - 1)) == 0, "[dptr::detail::side_table]: DPTR_SIDE_TABLE_SHARDS must be a power of two.");
+			struct entry
+			{
+				const void* key;
+				std::size_t count;
+			};
+			class alignas(DPTR_CACHE_LINE_SIZE) shard
+			{
+			public:
+				void lock() noexcept;
+				void unlock() noexcept;
+				// slot of key or the empty slot where it would be inserted. capacity must be > 0.
+				std::size_t find(const void* key, std::size_t hash) const noexcept;
+				std::size_t add_ref(const void* key, std::size_t hash) noexcept;
+				std::size_t release(const void* key, std::size_t hash) noexcept;
+				std::size_t count(const void* key, std::size_t hash) const noexcept;
+			private:
+				void grow() noexcept;
+				void erase(std::size_t slot) noexcept;
+
+				std::atomic<bool> m_locked{false};
+				// never freed, the table lives until the end of the program
+				entry* m_entries = nullptr;
+				std::size_t m_mask = 0u;
+				std::size_t m_size = 0u;
+			};
+			static std::size_t hash(const void* object) noexcept;
+			static shard& shard_of(std::size_t hash) noexcept;
+		};
+		#pragma endregion
+
+
+		#pragma region holder_tracking
+		// where a dependency_ptr acquired its reference. empty unless DPTR_TRACK_HOLDERS is enabled.
+		struct source_site
+		{
+			#if DPTR_TRACK_HOLDERS
+			const char* file;
+			unsigned line;
+			#if defined(__GNUC__) || defined(__clang__) || (defined(_MSC_VER) && _MSC_VER >= 1926)
+			static constexpr source_site current(const char* file = __builtin_FILE(), unsigned line = __builtin_LINE()) noexcept { return {file, line}; }
+			#else
+			static constexpr source_site current() noexcept { return {nullptr, 0u}; }
+			#endif
+			#else
+			static constexpr source_site current() noexcept { return {}; }
+			#endif
+		};
+
+		#if DPTR_TRACK_HOLDERS
+		// the complete object referenced by a dependency_ptr
+		struct tracked_object
+		{
+			const void* address = nullptr;
+			// sizeof the pointee type, a lower bound for polymorphic types
+			std::size_t size = 0u;
+			// implementation defined (mangled on GCC/Clang), nullptr without RTTI
+			const char* type_name = nullptr;
+		};
+		template <typename T>
+		tracked_object tracked_object_of(const T* ptr) noexcept;
+
+		class holder_registry;
+		struct holder_record
+		{
+			const void* holder = nullptr;
+			const void* dependency = nullptr;
+			tracked_object object;
+			source_site site = {nullptr, 0u};
+			std::thread::id thread;
+			holder_record* prev = nullptr;
+			holder_record* next = nullptr;
+			std::atomic<holder_registry*> registry{nullptr};
+		};
+
+		// Per-thread list of the holder records linked on this thread. A record released on another thread locks the list it
+		// is linked into, so the mutexes are uncontended unless pointers are passed between threads.
+		// Registries are never freed. Registries of exited threads (and their remaining records) are reused by new threads.
+		class holder_registry
+		{
+		public:
+			static holder_registry& this_thread();
+			void link(holder_record& record);
+			static void unlink(holder_record& record);
+			// calls visitor(const holder_record&) for every live record. locks one registry at a time.
+			template <typename visitor_t>
+			static void visit(visitor_t&& visitor);
+		private:
+			holder_registry() = default;
+			static std::atomic<holder_registry*>& all_registries() noexcept;
+
+			std::mutex m_mutex;
+			holder_record* m_head = nullptr;
+			holder_registry* m_next_registry = nullptr;
+			std::atomic<bool> m_in_use{true};
+		};
+		#endif
+
+		// base of dependency_pointer_impl, registers the pointer as holder of its dependency. empty unless DPTR_TRACK_HOLDERS is enabled.
+		class holder_tracker
+		{
+		public:
+			holder_tracker() noexcept = default;
+			holder_tracker(const holder_tracker&) = delete;
+			holder_tracker& operator=(const holder_tracker&) = delete;
+			#if DPTR_TRACK_HOLDERS
+			~holder_tracker();
+			void track(const void* holder, const void* dependency, const tracked_object& object, source_site site) noexcept;
+			void untrack() noexcept;
+			source_site site() const noexcept;
+		private:
+			holder_record m_record;
+			#else
+			DPTR_CONSTEXPR void untrack() noexcept {}
+			DPTR_CONSTEXPR source_site site() const noexcept { return {}; }
+			#endif
+		};
+
+		// prints the holders referencing dependency (guarded_dependency_impl address) if DPTR_TRACK_HOLDERS is enabled
+		inline void print_holders(const void* dependency, std::ostream& stream);
+
+		// true during constant evaluation, where atomics, statistics and violation handlers cannot be used
+		constexpr bool is_constant_evaluated() noexcept
+		{
+			#if DPTR_HAS_CONSTEXPR
+			return std::is_constant_evaluated();
+			#else
+			return false;
+			#endif
+		}
+		// calls the violation handler, unless the dependency of v is suppressed on the calling thread
+		void report_violation(const dptr::violation& v) noexcept;
+		// suppresses the violations of one dependency on the calling thread while it exists, e.g. for code which reported a violation
+		// of an object itself and destroys it afterwards (the object's destructor would report it again).
+		class violation_suppression
+		{
+		public:
+			explicit violation_suppression(const void* dependency) noexcept;
+			violation_suppression(const violation_suppression&) = delete;
+			violation_suppression& operator=(const violation_suppression&) = delete;
+			~violation_suppression();
+			static bool suppressed(const void* dependency) noexcept;
+		private:
+			static const void*& current() noexcept;
+			const void* m_previous;
+		};
+		DPTR_CONSTEXPR void check_unreferenced(dptr::dependency_op_flags op, std::size_t count, const void* dependency, const char* condition, const char* message, const char* file, unsigned line, std::size_t index = dptr::violation::no_index) noexcept;
+		#ifndef DPTR_VIOLATION_HANDLER
+		std::atomic<dptr::violation_handler>& violation_handler_storage() noexcept;
+		#endif
+		// called by releases of atomic guarded and side table dependencies which drop the count to 0 while a thread waits (see wait_for_release.hpp).
+		// releases only load the waiter flag while nobody waits. both are changed by the waiting threads, hook is nullptr while waiting is 0.
+		using release_hook = void (*)() noexcept;
+		struct release_hook_state
+		{
+			std::atomic<std::size_t> waiting{0u};
+			std::atomic<release_hook> hook{nullptr};
+		};
+		release_hook_state& release_hook_storage() noexcept;
+		#pragma endregion
+
+		#pragma region statistics
+		#if DPTR_COLLECT_STATS
+		// Reference count statistics of one dependency type. Every thread updates its own block with plain relaxed stores,
+		// blocks of exited threads are merged into m_retired. Instances are never freed.
+		class type_stats
+		{
+		public:
+			template <typename T>
+			static void record_add_ref(bool contended, std::size_t references) noexcept;
+			template <typename T>
+			static void record_release(bool contended) noexcept;
+			template <typename T>
+			static type_stats& of();
+			// calls visitor(const type_stats&) for every type with recorded statistics
+			template <typename visitor_t>
+			static void visit(visitor_t&& visitor);
+
+			const char* type_name() const noexcept { return m_type_name; }
+			bool is_atomic() const noexcept { return m_atomic; }
+			// sums up the blocks of all threads
+			void collect(std::uint64_t& add_refs, std::uint64_t& releases, std::uint64_t& contended, std::uint64_t& peak_references);
+		private:
+			struct block
+			{
+				std::atomic<std::uint64_t> add_refs{0u};
+				std::atomic<std::uint64_t> releases{0u};
+				std::atomic<std::uint64_t> contended{0u};
+				std::atomic<std::uint64_t> peak_references{0u};
+				block* prev = nullptr;
+				block* next = nullptr;
+			};
+			// trivially destructible, so it can still be checked after the thread_block was destroyed on thread exit
+			struct thread_slot
+			{
+				block* data;
+				bool exited;
+			};
+			// registers a block of the calling thread for as long as the thread lives
+			class thread_block
+			{
+			public:
+				thread_block(type_stats& stats, thread_slot& slot);
+				~thread_block();
+				block data;
+			private:
+				type_stats& m_stats;
+				thread_slot& m_slot;
+			};
+			type_stats(const char* type_name, bool atomic) noexcept;
+			// nullptr if the block of the calling thread was already destroyed (references released during thread exit)
+			template <typename T>
+			static block* this_thread_block();
+			static std::atomic<type_stats*>& all_types() noexcept;
+			// adds to a block which is only written by one thread at a time. readers only need untorn values.
+			static void add(block& data, std::uint64_t add_refs, std::uint64_t releases, std::uint64_t contended, std::uint64_t references) noexcept;
+			// fallback for this_thread_block() == nullptr
+			void add_locked(std::uint64_t add_refs, std::uint64_t releases, std::uint64_t contended, std::uint64_t references);
+
+			const char* m_type_name;
+			bool m_atomic;
+			std::mutex m_mutex;
+			block* m_blocks = nullptr;
+			block m_retired;
+			type_stats* m_next_type = nullptr;
+		};
+		#endif
+		#pragma endregion
+
 		#pragma region dependency_ptr_impl
 		template <typename T>
-		class dependency_pointer_impl : public intrusive_ptr<T>
+		class dependency_ref_impl;
+
+		// counts the dependency_refs borrowed from a dependency_pointer_impl (and the references to the elements of a guarded_vector).
+		// always an std::atomic, so that its type does not depend on T, which may still be incomplete (e.g. in struct node { dependency_ptr<node> next; }).
+		// borrows from non-atomic dependencies only use relaxed loads and stores, which are as cheap as plain increments.
+		class borrow_counter
+		{
+		public:
+			borrow_counter() noexcept = default;
+			borrow_counter(const borrow_counter&) = delete;
+			borrow_counter& operator=(const borrow_counter&) = delete;
+			template <bool atomic>
+			void inc() noexcept;
+			template <bool atomic>
+			void dec() noexcept;
+			std::size_t load() const noexcept;
+		private:
+			std::atomic<std::size_t> m_count{0u};
+		};
+
+		// intrusive_ptr which additionally counts the dependency_refs borrowing from it and registers itself as holder of its dependency.
+		// the pointer must not be destroyed or changed while it is borrowed from.
+		// constructors and reset take the acquisition site as defaulted last parameter (used by DPTR_TRACK_HOLDERS).
+		template <typename T>
+		class dependency_pointer_impl : public intrusive_ptr<T>, private holder_tracker
+		{
+			template <typename U> friend class dependency_pointer_impl;
+			template <typename U> friend class dependency_ref_impl;
+		public:
+			DPTR_CONSTEXPR dependency_pointer_impl() noexcept;
+			DPTR_CONSTEXPR dependency_pointer_impl(T* ptr, bool add_ref = true, source_site site = source_site::current());
+			DPTR_CONSTEXPR dependency_pointer_impl(const dependency_pointer_impl& other, source_site site = source_site::current());
+			template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+			DPTR_CONSTEXPR dependency_pointer_impl(const dependency_pointer_impl<U>& other, source_site site = source_site::current());
+			DPTR_CONSTEXPR dependency_pointer_impl(dependency_pointer_impl&& other) noexcept;
+			template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+			DPTR_CONSTEXPR dependency_pointer_impl(dependency_pointer_impl<U>&& other) noexcept;
+			DPTR_CONSTEXPR dependency_pointer_impl& operator=(const dependency_pointer_impl& other);
+			DPTR_CONSTEXPR dependency_pointer_impl& operator=(dependency_pointer_impl&& other) noexcept;
+			DPTR_CONSTEXPR dependency_pointer_impl& operator=(T* ptr);
+			DPTR_CONSTEXPR ~dependency_pointer_impl();
+
+			DPTR_CONSTEXPR void reset();
+			DPTR_CONSTEXPR void reset(T* ptr, source_site site = source_site::current());
+			DPTR_CONSTEXPR void reset(T* ptr, bool add_ref, source_site site = source_site::current());
+			DPTR_CONSTEXPR T* detach() noexcept;
+			DPTR_CONSTEXPR void swap(dependency_pointer_impl& rhs) noexcept;
+
+			DPTR_CONSTEXPR operator typename intrusive_ptr<T>::pointer() const noexcept { return intrusive_ptr<T>::get(); }
+		private:
+			DPTR_CONSTEXPR bool is_borrowed() const noexcept;
+			// updates the holder registry after the pointer changed
+			DPTR_CONSTEXPR void retrack(source_site site) noexcept;
+			mutable borrow_counter m_borrows;
+		};
+
+		// non-counting reference borrowed from a dependency_pointer_impl. only counts the borrows of its source pointer,
+		// which is (unlike the counter of the dependency) local to the code passing the pointer around.
+		template <typename T>
+		class dependency_ref_impl
 		{
-			static_assert(is_guarded_dependency<T>::value, "[dptr::detail::dependency_pointer_impl]: dependency_ptr can only be used with types deriving guarded_dependency.");
+			template <typename U> friend class dependency_ref_impl;
 		public:
-			using intrusive_ptr<T>::intrusive_ptr;
-			operator typename intrusive_ptr<T>::pointer() const noexcept { return intrusive_ptr<T>::get(); }
+			using element_type = T;
+			using pointer = T*;
+
+			dependency_ref_impl() noexcept;
+			template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+			dependency_ref_impl(const dependency_pointer_impl<U>& source) noexcept;
+			dependency_ref_impl(const dependency_ref_impl& other) noexcept;
+			template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+			dependency_ref_impl(const dependency_ref_impl<U>& other) noexcept;
+			dependency_ref_impl& operator=(const dependency_ref_impl& other) noexcept;
+			~dependency_ref_impl();
+
+			T& operator*() const noexcept;
+			T* operator->() const noexcept;
+			T* get() const noexcept;
+			explicit operator bool() const noexcept;
+			operator T*() const noexcept;
+		private:
+			dependency_ref_impl(T* ptr, borrow_counter* borrows) noexcept;
+			T* m_ptr;
+			borrow_counter* m_borrows;
 		};
 		#pragma endregion
 	}
 	template <typename T>
-	using dependency_ptr = detail::debug_type_choice_t<detail::dependency_pointer_impl<T>, T*>;
-	template <bool atomic = false, dependency_op_flags forbidden_ops = dependency_op::destroy | dependency_op::move_from | dependency_op::assign>
-	using guarded_dependency = detail::debug_type_choice_t<detail::guarded_dependency_impl<atomic, forbidden_ops>, detail::guarded_dependency_nop<atomic, forbidden_ops>>;	
+	using dependency_ptr = detail::check_mode_choice_t<dependency_check_mode_v<T>, detail::dependency_pointer_impl<T>, T*>;
+	// non-counting reference to a dependency for passing dependency_ptrs into hot functions. has to be created from a dependency_ptr
+	// and must not outlive it (checked in debug builds). plain T* in release builds.
+	template <typename T>
+	using dependency_ref = detail::check_mode_choice_t<dependency_check_mode_v<T>, detail::dependency_ref_impl<T>, T*>;
+	template <bool atomic = false, dependency_op_flags forbidden_ops = dependency_op::destroy | dependency_op::move_from | dependency_op::assign, typename counter_policy = default_counter<atomic>, check_mode mode = default_check_mode>
+	using guarded_dependency = detail::check_mode_choice_t<mode, detail::guarded_dependency_impl<atomic, forbidden_ops, detail::check_mode_counter_t<mode, counter_policy>>, detail::guarded_dependency_nop<atomic, forbidden_ops, counter_policy>>;	
+	// guarded_dependency using the check mode of dependency_check_mode<T>, so that T and dependency_ptr<T> always agree.
+	// class T : public guarded_dependency_for<T, ...> { ... };
+	template <typename T, bool atomic = false, dependency_op_flags forbidden_ops = dependency_op::destroy | dependency_op::move_from | dependency_op::assign, typename counter_policy = default_counter<atomic>>
+	using guarded_dependency_for = guarded_dependency<atomic, forbidden_ops, counter_policy, dependency_check_mode_v<T>>;
+
+	// Arena level guard for objects that are released all at once. Objects derive from arena_dependency (of the same parameters)
+	// and bind to an arena on construction, references to them are counted by the arena. Checking that nothing references
+	// the arena before it is reset is O(1) and the objects do not need to be destroyed individually.
+	template <bool atomic = false, typename counter_policy = default_counter<atomic>, check_mode mode = default_check_mode>
+	using guarded_arena = detail::check_mode_choice_t<mode, detail::guarded_arena_impl<atomic, detail::check_mode_counter_t<mode, counter_policy>>, detail::guarded_arena_nop<atomic, counter_policy>>;
+	template <bool atomic = false, typename counter_policy = default_counter<atomic>, check_mode mode = default_check_mode>
+	using arena_dependency = detail::check_mode_choice_t<mode, detail::arena_dependency_impl<atomic, detail::check_mode_counter_t<mode, counter_policy>>, detail::arena_dependency_nop<atomic, counter_policy>>;
+
+	#if DPTR_TRACK_HOLDERS
+	// a live dependency_ptr as recorded by DPTR_TRACK_HOLDERS
+	struct holder_info
+	{
+		const void* holder;
+		// address of the guarded_dependency base of the referenced object
+		const void* dependency;
+		// address, size (lower bound for polymorphic types) and typeid name of the complete referenced object
+		const void* object;
+		std::size_t object_size;
+		const char* type_name;
+		// acquisition site, nullptr/0 if unknown (e.g. assigned from T*)
+		const char* file;
+		unsigned line;
+		std::thread::id thread;
+	};
+	// calls visitor(const holder_info&) for every live dependency_ptr. must not create or destroy dependency_ptrs.
+	template <typename visitor_t>
+	void for_each_holder(visitor_t&& visitor);
+	#endif
+	// prints the dependency_ptrs referencing dependency. only prints anything with DPTR_TRACK_HOLDERS and checked T.
+	template <typename T>
+	void print_holders(const T& dependency, std::ostream& stream DPTR_DEFAULT_OSTREAM);
+
+	#if DPTR_COLLECT_STATS
+	// reference count statistics of a dependency type as recorded by DPTR_COLLECT_STATS
+	struct dependency_stats
+	{
+		// typeid name, nullptr without RTTI
+		const char* type_name;
+		bool atomic;
+		std::uint64_t add_refs;
+		std::uint64_t releases;
+		// reference count updates whose first attempt failed because another thread updated the same counter.
+		// only detected for counter policies providing try_inc() and try_dec() (default_counter<true>).
+		std::uint64_t contended;
+		// highest reference count of a single object observed after an add_ref
+		std::uint64_t peak_references;
+	};
+	template <typename T>
+	dependency_stats stats_of();
+	// calls visitor(const dependency_stats&) for every dependency type referenced so far
+	template <typename visitor_t>
+	void for_each_stats(visitor_t&& visitor);
+	#endif
+	// prints the statistics of all dependency types as CSV (nothing unless DPTR_COLLECT_STATS is enabled)
+	void dump_stats(std::ostream& stream DPTR_DEFAULT_OSTREAM);
+
+	// asserts that no dependency_ptr references object. side table dependencies have to call this before they are destroyed,
+	// moved from or assigned to, guarded dependencies can use it for additional checks. no-op for unchecked types.
+	template <typename T>
+	void assert_unreferenced(const T& object);
+	// deleter for std::unique_ptr (replaces std::default_delete), calls assert_unreferenced before deleting
+	template <typename T>
+	struct checked_delete
+	{
+		void operator()(T* ptr) const;
+	};
 }
 
+// specializes dptr::side_table_dependency for type. must be used in the global namespace.
+#define DPTR_SIDE_TABLE_DEPENDENCY(type)\
+	template <> struct dptr::side_table_dependency<type> : std::true_type {}
+
+// specializes dptr::dependency_check_mode for type (off, sampled or full). must be used in the global namespace.
+#define DPTR_DEPENDENCY_CHECK_MODE(type, mode)\
+	template <> struct dptr::dependency_check_mode<type> : std::integral_constant<dptr::check_mode, dptr::check_mode::mode> {}
+
 #pragma region implementation
 template<typename T>
-inline dptr::detail::intrusive_ptr<T>::intrusive_ptr() noexcept :
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>::intrusive_ptr() noexcept :
 	m_ptr(nullptr)
 {
 }
 template<typename T>
-inline dptr::detail::intrusive_ptr<T>::intrusive_ptr(T* ptr, bool add_ref) :
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>::intrusive_ptr(T* ptr, bool add_ref) :
 	m_ptr(ptr)
 {
 	if(ptr && add_ref) intrusive_ptr_add_ref(m_ptr);
 }
 template<typename T>
-inline dptr::detail::intrusive_ptr<T>::intrusive_ptr(const intrusive_ptr& other) :
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>::intrusive_ptr(const intrusive_ptr& other) :
 	m_ptr(other.m_ptr)
 {
 	if(m_ptr) intrusive_ptr_add_ref(m_ptr);
 }
 template <typename T>
 template <typename U>
-inline dptr::detail::intrusive_ptr<T>::intrusive_ptr(const intrusive_ptr<U>& other) :
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>::intrusive_ptr(const intrusive_ptr<U>& other) :
 	m_ptr(other.m_ptr)
 {
 	if(m_ptr) intrusive_ptr_add_ref(m_ptr);
 }
 template<typename T>
-inline dptr::detail::intrusive_ptr<T>& dptr::detail::intrusive_ptr<T>::operator=(const intrusive_ptr& other)
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>& dptr::detail::intrusive_ptr<T>::operator=(const intrusive_ptr& other)
 {
 	intrusive_ptr(other).swap(*this);
 	return *this;
 }
 template <typename T>
 template <typename U>
-inline dptr::detail::intrusive_ptr<T>& dptr::detail::intrusive_ptr<T>::operator=(const intrusive_ptr<U>& other)
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>& dptr::detail::intrusive_ptr<T>::operator=(const intrusive_ptr<U>& other)
 {
 	intrusive_ptr(other).swap(*this);
 	return *this;
 }
 template<typename T>
-inline dptr::detail::intrusive_ptr<T>::intrusive_ptr(intrusive_ptr&& other) noexcept :
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>::intrusive_ptr(intrusive_ptr&& other) noexcept :
 	m_ptr(std::exchange(other.m_ptr, nullptr))
 {
 }
 template <typename T>
 template <typename U>
-inline dptr::detail::intrusive_ptr<T>::intrusive_ptr(intrusive_ptr<U>&& other) noexcept :
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>::intrusive_ptr(intrusive_ptr<U>&& other) noexcept :
 	m_ptr(std::exchange(other.m_ptr, nullptr))
 {
 }
 template<typename T>
-inline dptr::detail::intrusive_ptr<T>& dptr::detail::intrusive_ptr<T>::operator=(intrusive_ptr&& other) noexcept
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>& dptr::detail::intrusive_ptr<T>::operator=(intrusive_ptr&& other) noexcept
 {
 	intrusive_ptr(std::move(other)).swap(*this);
 	return *this;
 }
 template <typename T>
 template <typename U>
-inline dptr::detail::intrusive_ptr<T>& dptr::detail::intrusive_ptr<T>::operator=(intrusive_ptr<U>&& other) noexcept
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>& dptr::detail::intrusive_ptr<T>::operator=(intrusive_ptr<U>&& other) noexcept
 {
 	intrusive_ptr(std::move(other)).swap(*this);
 	return *this;
 }
 template<typename T>
-inline dptr::detail::intrusive_ptr<T>& dptr::detail::intrusive_ptr<T>::operator=(T* ptr)
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>& dptr::detail::intrusive_ptr<T>::operator=(T* ptr)
 {
 	intrusive_ptr(ptr).swap(*this);
 	return *this;
 }
 template<typename T>
-inline void dptr::detail::intrusive_ptr<T>::reset()
+DPTR_CONSTEXPR inline void dptr::detail::intrusive_ptr<T>::reset()
 {
 	intrusive_ptr().swap(*this);
 }
 template<typename T>
-inline void dptr::detail::intrusive_ptr<T>::reset(T* ptr)
+DPTR_CONSTEXPR inline void dptr::detail::intrusive_ptr<T>::reset(T* ptr)
 {
 	intrusive_ptr(ptr).swap(*this);
 }
 template<typename T>
-inline void dptr::detail::intrusive_ptr<T>::reset(T* ptr, bool add_ref)
+DPTR_CONSTEXPR inline void dptr::detail::intrusive_ptr<T>::reset(T* ptr, bool add_ref)
 {
 	intrusive_ptr(ptr, add_ref).swap(*this);
 }
 template<typename T>
-inline T& dptr::detail::intrusive_ptr<T>::operator*() const noexcept
+DPTR_CONSTEXPR inline T& dptr::detail::intrusive_ptr<T>::operator*() const noexcept
 {
 	DPTR_ASSERT(m_ptr, "[dptr::detail::intrusive_ptr::operator*]: nullptr access.");
 	return *m_ptr;
 }
 template<typename T>
-inline T* dptr::detail::intrusive_ptr<T>::operator->() const noexcept
+DPTR_CONSTEXPR inline T* dptr::detail::intrusive_ptr<T>::operator->() const noexcept
 {
 	DPTR_ASSERT(m_ptr, "[dptr::detail::intrusive_ptr::operator->]: nullptr access.");
 	return m_ptr;
 }
 template<typename T>
-inline T* dptr::detail::intrusive_ptr<T>::get() const noexcept
+DPTR_CONSTEXPR inline T* dptr::detail::intrusive_ptr<T>::get() const noexcept
 {
 	return m_ptr;
 }
 template<typename T>
-inline T* dptr::detail::intrusive_ptr<T>::detach() noexcept
+DPTR_CONSTEXPR inline T* dptr::detail::intrusive_ptr<T>::detach() noexcept
 {
 	return std::exchange(m_ptr, nullptr);
 }
 template<typename T>
-inline dptr::detail::intrusive_ptr<T>::operator bool() const noexcept
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>::operator bool() const noexcept
 {
 	return m_ptr;
 }
 template<typename T>
-inline void dptr::detail::intrusive_ptr<T>::swap(intrusive_ptr& rhs) noexcept
+DPTR_CONSTEXPR inline void dptr::detail::intrusive_ptr<T>::swap(intrusive_ptr& rhs) noexcept
 {
 	using std::swap;
 	swap(m_ptr, rhs.m_ptr);
 }
 template<typename T>
-inline dptr::detail::intrusive_ptr<T>::~intrusive_ptr()
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T>::~intrusive_ptr()
 {
 	if(m_ptr) intrusive_ptr_release(m_ptr);
 }
 template<typename T, typename U>
-inline bool dptr::detail::operator==(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept
+DPTR_CONSTEXPR inline bool dptr::detail::operator==(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept
 {
-	return lhs.get() != rhs.get();
+	return lhs.get() == rhs.get();
 }
 template<typename T, typename U>
-inline bool dptr::detail::operator!=(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept
+DPTR_CONSTEXPR inline bool dptr::detail::operator!=(const intrusive_ptr<T>& lhs, const intrusive_ptr<U>& rhs) noexcept
 {
 	return lhs.get() != rhs.get();
 }
 template<typename T, typename U>
-inline bool dptr::detail::operator==(const intrusive_ptr<T>& lhs, U* rhs) noexcept
+DPTR_CONSTEXPR inline bool dptr::detail::operator==(const intrusive_ptr<T>& lhs, U* rhs) noexcept
 {
 	return lhs.get() == rhs;
 }
 template<typename T, typename U>
-inline bool dptr::detail::operator!=(const intrusive_ptr<T>& lhs, U* rhs) noexcept
+DPTR_CONSTEXPR inline bool dptr::detail::operator!=(const intrusive_ptr<T>& lhs, U* rhs) noexcept
 {
 	return lhs.get() != rhs;
 }
 template<typename T, typename U>
-inline bool dptr::detail::operator==(U* lhs, const intrusive_ptr<T>& rhs) noexcept
+DPTR_CONSTEXPR inline bool dptr::detail::operator==(U* lhs, const intrusive_ptr<T>& rhs) noexcept
 {
 	return lhs == rhs.get();
 }
 template<typename T, typename U>
-inline bool dptr::detail::operator!=(U* lhs, const intrusive_ptr<T>& rhs) noexcept
+DPTR_CONSTEXPR inline bool dptr::detail::operator!=(U* lhs, const intrusive_ptr<T>& rhs) noexcept
 {
 	return lhs != rhs.get();
 }
 template<typename T>
-inline void dptr::detail::swap(intrusive_ptr<T>& lhs, intrusive_ptr<T>& rhs) noexcept
+DPTR_CONSTEXPR inline void dptr::detail::swap(intrusive_ptr<T>& lhs, intrusive_ptr<T>& rhs) noexcept
 {
 	lhs.swap(rhs);
 }
@@ -409,17 +1195,17 @@ inline T* dptr::detail::get_pointer(const intrusive_ptr<T>& iptr) noexcept
 	return iptr.get();
 }
 template<typename T, typename U>
-inline dptr::detail::intrusive_ptr<T> dptr::detail::static_pointer_cast(const intrusive_ptr<U>& iptr) noexcept
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T> dptr::detail::static_pointer_cast(const intrusive_ptr<U>& iptr) noexcept
 {
 	return intrusive_ptr(static_cast<typename intrusive_ptr<T>::element_type*>(iptr.get()));
 }
 template<typename T, typename U>
-inline dptr::detail::intrusive_ptr<T> dptr::detail::const_pointer_cast(const intrusive_ptr<U>& iptr) noexcept
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T> dptr::detail::const_pointer_cast(const intrusive_ptr<U>& iptr) noexcept
 {
 	return intrusive_ptr(const_cast<typename intrusive_ptr<T>::element_type*>(iptr.get()));
 }
 template<typename T, typename U>
-inline dptr::detail::intrusive_ptr<T> dptr::detail::dynamic_pointer_cast(const intrusive_ptr<U>& iptr) noexcept
+DPTR_CONSTEXPR inline dptr::detail::intrusive_ptr<T> dptr::detail::dynamic_pointer_cast(const intrusive_ptr<U>& iptr) noexcept
 {
 	return intrusive_ptr(dynamic_cast<typename intrusive_ptr<T>::element_type*>(iptr.get()));
 }
@@ -429,205 +1215,1230 @@ inline std::basic_ostream<Elem, Traits>& dptr::detail::operator<<(std::basic_ost
 	return strm << iptr.get();
 }
 
-inline constexpr dptr::dependency_op_flags dptr::operator~(dependency_op op) noexcept
+// --- holder tracking
+#if DPTR_TRACK_HOLDERS
+template <typename T>
+inline dptr::detail::tracked_object dptr::detail::tracked_object_of(const T* ptr) noexcept
 {
-	return ~static_cast<dependency_op_flags>(op);
+	if(!ptr) return {};
+	#if defined(__cpp_rtti) || defined(__GXX_RTTI) || defined(_CPPRTTI)
+	if constexpr(std::is_polymorphic_v<T>)
+		return {dynamic_cast<const void*>(ptr), sizeof(T), typeid(*ptr).name()};
+	else
+		return {ptr, sizeof(T), typeid(T).name()};
+	#else
+	return {ptr, sizeof(T), nullptr};
+	#endif
 }
-
-inline constexpr dptr::dependency_op_flags dptr::operator|(dependency_op lhs, dependency_op rhs) noexcept
+inline std::atomic<dptr::detail::holder_registry*>& dptr::detail::holder_registry::all_registries() noexcept
 {
-	return static_cast<dependency_op_flags>(lhs) | static_cast<dependency_op_flags>(rhs);
+	static std::atomic<holder_registry*> head{nullptr};
+	return head;
 }
-
-constexpr dptr::dependency_op_flags dptr::operator|(dependency_op_flags lhs, dependency_op rhs) noexcept
+inline dptr::detail::holder_registry& dptr::detail::holder_registry::this_thread()
 {
-	return lhs | static_cast<dependency_op_flags>(rhs);
+	// marks the registry as free again when the thread exits
+	struct registry_lease
+	{
+		holder_registry* registry;
+		~registry_lease() { registry->m_in_use.store(false, std::memory_order_release); }
+	};
+	thread_local const registry_lease lease{[]()
+	{
+		auto& head = all_registries();
+		for(holder_registry* registry = head.load(std::memory_order_acquire); registry; registry = registry->m_next_registry)
+		{
+			bool in_use = false;
+			if(!registry->m_in_use.load(std::memory_order_relaxed) && registry->m_in_use.compare_exchange_strong(in_use, true, std::memory_order_acquire))
+				return registry;
+		}
+		holder_registry* registry = new holder_registry();
+		registry->m_next_registry = head.load(std::memory_order_relaxed);
+		while(!head.compare_exchange_weak(registry->m_next_registry, registry, std::memory_order_release, std::memory_order_relaxed));
+		return registry;
+	}()};
+	return *lease.registry;
+}
+inline void dptr::detail::holder_registry::link(holder_record& record)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	record.prev = nullptr;
+	record.next = m_head;
+	if(m_head) m_head->prev = &record;
+	m_head = &record;
+	record.registry.store(this, std::memory_order_relaxed);
+}
+inline void dptr::detail::holder_registry::unlink(holder_record& record)
+{
+	holder_registry* const registry = record.registry.load(std::memory_order_relaxed);
+	if(!registry) return;
+	std::lock_guard<std::mutex> lock(registry->m_mutex);
+	if(record.prev) record.prev->next = record.next;
+	else registry->m_head = record.next;
+	if(record.next) record.next->prev = record.prev;
+	record.prev = record.next = nullptr;
+	record.registry.store(nullptr, std::memory_order_relaxed);
+}
+template <typename visitor_t>
+inline void dptr::detail::holder_registry::visit(visitor_t&& visitor)
+{
+	for(holder_registry* registry = all_registries().load(std::memory_order_acquire); registry; registry = registry->m_next_registry)
+	{
+		std::lock_guard<std::mutex> lock(registry->m_mutex);
+		for(const holder_record* record = registry->m_head; record; record = record->next)
+			visitor(*record);
+	}
 }
 
-constexpr dptr::dependency_op_flags dptr::operator|(dependency_op lhs, dependency_op_flags rhs) noexcept
+inline dptr::detail::holder_tracker::~holder_tracker()
 {
-	return static_cast<dependency_op_flags>(lhs) | rhs;
+	untrack();
 }
-
-inline constexpr dptr::dependency_op_flags dptr::operator&(dependency_op lhs, dependency_op rhs) noexcept
+inline void dptr::detail::holder_tracker::track(const void* holder, const void* dependency, const tracked_object& object, source_site site) noexcept
 {
-	return static_cast<dependency_op_flags>(lhs) & static_cast<dependency_op_flags>(rhs);
+	untrack();
+	m_record.holder = holder;
+	m_record.dependency = dependency;
+	m_record.object = object;
+	m_record.site = site;
+	if(!dependency) return;
+	m_record.thread = std::this_thread::get_id();
+	// tracking is a debugging aid, running out of memory for a thread's registry terminates
+	holder_registry::this_thread().link(m_record);
 }
-
-constexpr dptr::dependency_op_flags dptr::operator&(dependency_op_flags lhs, dependency_op rhs) noexcept
+inline void dptr::detail::holder_tracker::untrack() noexcept
 {
-	return lhs & static_cast<dependency_op_flags>(rhs);
+	holder_registry::unlink(m_record);
+	m_record.dependency = nullptr;
 }
-
-constexpr dptr::dependency_op_flags dptr::operator&(dependency_op lhs, dependency_op_flags rhs) noexcept
+inline dptr::detail::source_site dptr::detail::holder_tracker::site() const noexcept
 {
-	return static_cast<dependency_op_flags>(lhs) & rhs;
+	return m_record.site;
 }
-
-inline constexpr dptr::dependency_op_flags dptr::operator^(dependency_op lhs, dependency_op rhs) noexcept
+inline void dptr::detail::print_holders(const void* dependency, std::ostream& stream)
 {
-	return static_cast<dependency_op_flags>(lhs) ^ static_cast<dependency_op_flags>(rhs);
+	std::size_t count = 0u;
+	holder_registry::visit([&](const holder_record& record)
+	{
+		if(record.dependency != dependency) return;
+		stream << "\tholder: " << record.holder << ", acquired at " << (record.site.file ? record.site.file : "<unknown>") << ':' << record.site.line << ", thread " << record.thread << '\n';
+		++count;
+	});
+	stream << "\t" << count << " holder(s) of " << dependency << std::endl;
 }
 
-constexpr dptr::dependency_op_flags dptr::operator^(dependency_op_flags lhs, dependency_op rhs) noexcept
+template <typename visitor_t>
+inline void dptr::for_each_holder(visitor_t&& visitor)
 {
-	return lhs ^ static_cast<dependency_op_flags>(rhs);
+	detail::holder_registry::visit([&](const detail::holder_record& record)
+	{
+		visitor(holder_info{record.holder, record.dependency, record.object.address, record.object.size, record.object.type_name, record.site.file, record.site.line, record.thread});
+	});
 }
-
-constexpr dptr::dependency_op_flags dptr::operator^(dependency_op lhs, dependency_op_flags rhs) noexcept
+#else
+inline void dptr::detail::print_holders(const void*, std::ostream&)
 {
-	return static_cast<dependency_op_flags>(lhs) ^ rhs;
 }
-
-inline constexpr dptr::dependency_op_flags& dptr::operator|=(dependency_op_flags& lhs, dependency_op rhs) noexcept
+#endif
+template <typename T>
+inline void dptr::print_holders(const T& dependency, std::ostream& stream)
 {
-	return lhs |= static_cast<dependency_op_flags>(rhs);
+	if constexpr(detail::is_checked_dependency_v<T>)
+		detail::print_holders(detail::dependency_address(&dependency), stream);
 }
 
-inline constexpr dptr::dependency_op_flags& dptr::operator&=(dependency_op_flags& lhs, dependency_op rhs) noexcept
+// --- violations
+inline void dptr::detail::report_violation(const dptr::violation& v) noexcept
 {
-	return lhs &= static_cast<dependency_op_flags>(rhs);
+	if(violation_suppression::suppressed(v.dependency)) return;
+	#ifdef DPTR_VIOLATION_HANDLER
+	DPTR_VIOLATION_HANDLER(v);
+	#else
+	const dptr::violation_handler handler = violation_handler_storage().load(std::memory_order_acquire);
+	if(handler)
+		handler(v);
+	else
+		default_violation_handler(v);
+	#endif
 }
-
-inline constexpr dptr::dependency_op_flags& dptr::operator^=(dependency_op_flags& lhs, dependency_op rhs) noexcept
+inline dptr::detail::violation_suppression::violation_suppression(const void* dependency) noexcept :
+	m_previous(std::exchange(current(), dependency))
 {
-	return lhs ^= static_cast<dependency_op_flags>(rhs);
 }
-
-// --- atomic version
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<true, forbidden_ops>::guarded_dependency_impl() noexcept :
-	m_counter(0ull)
+inline dptr::detail::violation_suppression::~violation_suppression()
 {
-	// new object at new address, init counter to 0
+	current() = m_previous;
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<true, forbidden_ops>::guarded_dependency_impl(const guarded_dependency_impl& other) noexcept :
-	m_counter(0ull)
+inline bool dptr::detail::violation_suppression::suppressed(const void* dependency) noexcept
 {
-	// new object at new address, init counter to 0
-	if constexpr(forbidden_ops & dependency_op::copy_from)
-		DPTR_ASSERT(other.m_counter.load(std::memory_order_relaxed) == 0ull, "[dptr::detail::guarded_dependency_impl::guarded_dependency_impl(copy ctor)]: There were still (now invalid!) pointers referencing the copied-from object.");
+	return dependency && dependency == current();
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<true, forbidden_ops>::guarded_dependency_impl(guarded_dependency_impl&& other) noexcept :
-	m_counter(0ull)
+inline const void*& dptr::detail::violation_suppression::current() noexcept
 {
-	// new object at new address, init counter to 0
-	// if there are still references, moving from the object causes undefined behaviour
-	if constexpr(forbidden_ops & dependency_op::move_from)
-		DPTR_ASSERT(other.m_counter.load(std::memory_order_relaxed) == 0ull, "[dptr::detail::guarded_dependency_impl::guarded_dependency_impl(move ctor)]: There were still (now invalid!) pointers referencing the moved-from object.");
+	thread_local const void* dependency = nullptr;
+	return dependency;
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<true, forbidden_ops>& dptr::detail::guarded_dependency_impl<true, forbidden_ops>::operator=(const guarded_dependency_impl& other) noexcept
+DPTR_CONSTEXPR inline void dptr::detail::check_unreferenced(dptr::dependency_op_flags op, std::size_t count, const void* dependency, const char* condition, const char* message, const char* file, unsigned line, std::size_t index) noexcept
 {
-	// object stays at the same address => do not modify counter
-	if constexpr(forbidden_ops & dependency_op::copy_from)
-		DPTR_ASSERT(other.m_counter.load(std::memory_order_relaxed) == 0ull, "[dptr::detail::guarded_dependency_impl::opeartor=(copy)]: There were still (now invalid!) pointers referencing the copied-from object.");
-	if constexpr(forbidden_ops & dependency_op::copy_assign)
-		DPTR_ASSERT(m_counter.load(std::memory_order_relaxed) == 0ull, "[dptr::detail::guarded_dependency_impl::operator=(copy)]: There were still (now possibly invalid!) pointers referencing the assigned object.");	
+	if(count != 0u)
+		report_violation(dptr::violation{op, dependency, count, condition, message, file, line, index});
+}
+#ifndef DPTR_VIOLATION_HANDLER
+inline std::atomic<dptr::violation_handler>& dptr::detail::violation_handler_storage() noexcept
+{
+	static std::atomic<dptr::violation_handler> handler{nullptr};
+	return handler;
+}
+inline dptr::violation_handler dptr::set_violation_handler(violation_handler handler) noexcept
+{
+	return detail::violation_handler_storage().exchange(handler, std::memory_order_acq_rel);
+}
+inline dptr::violation_handler dptr::get_violation_handler() noexcept
+{
+	const violation_handler handler = detail::violation_handler_storage().load(std::memory_order_acquire);
+	return handler ? handler : &default_violation_handler;
+}
+inline void dptr::default_violation_handler(const violation& v) noexcept
+{
+	std::cerr << "Assertion failed: (" << v.condition << ")\n"
+		"\tfile: " << v.file << "\n"
+		"\tline: " << v.line << "\n"
+		"\tmessage:" << v.message << '\n';
+	if(v.index != violation::no_index)
+		std::cerr << "\telement: " << v.index << '\n';
+	if(v.dependency)
+	{
+		std::cerr << "\tdependency: " << v.dependency << ", referenced by " << v.count << " pointer(s)\n";
+		detail::print_holders(v.dependency, std::cerr);
+	}
+	std::cerr.flush();
+	std::abort();
+}
+#endif
+inline dptr::detail::release_hook_state& dptr::detail::release_hook_storage() noexcept
+{
+	static release_hook_state state;
+	return state;
+}
+
+// --- statistics
+#if DPTR_COLLECT_STATS
+inline dptr::detail::type_stats::type_stats(const char* type_name, bool atomic) noexcept :
+	m_type_name(type_name),
+	m_atomic(atomic)
+{
+}
+inline std::atomic<dptr::detail::type_stats*>& dptr::detail::type_stats::all_types() noexcept
+{
+	static std::atomic<type_stats*> head{nullptr};
+	return head;
+}
+template <typename T>
+inline dptr::detail::type_stats& dptr::detail::type_stats::of()
+{
+	static type_stats& stats = []() -> type_stats&
+	{
+		// unchecked types never record anything
+		constexpr bool atomic = is_checked_dependency_v<T> && is_ref_counter_atomic<T>::value;
+		#if defined(__cpp_rtti) || defined(__GXX_RTTI) || defined(_CPPRTTI)
+		type_stats* const stats = new type_stats(typeid(T).name(), atomic);
+		#else
+		type_stats* const stats = new type_stats(nullptr, atomic);
+		#endif
+		auto& head = all_types();
+		stats->m_next_type = head.load(std::memory_order_relaxed);
+		while(!head.compare_exchange_weak(stats->m_next_type, stats, std::memory_order_release, std::memory_order_relaxed));
+		return *stats;
+	}();
+	return stats;
+}
+template <typename visitor_t>
+inline void dptr::detail::type_stats::visit(visitor_t&& visitor)
+{
+	for(type_stats* stats = all_types().load(std::memory_order_acquire); stats; stats = stats->m_next_type)
+		visitor(*stats);
+}
+inline dptr::detail::type_stats::thread_block::thread_block(type_stats& stats, thread_slot& slot) :
+	m_stats(stats),
+	m_slot(slot)
+{
+	std::lock_guard<std::mutex> lock(m_stats.m_mutex);
+	data.next = m_stats.m_blocks;
+	if(data.next) data.next->prev = &data;
+	m_stats.m_blocks = &data;
+}
+inline dptr::detail::type_stats::thread_block::~thread_block()
+{
+	std::lock_guard<std::mutex> lock(m_stats.m_mutex);
+	if(data.prev) data.prev->next = data.next;
+	else m_stats.m_blocks = data.next;
+	if(data.next) data.next->prev = data.prev;
+	add(m_stats.m_retired, data.add_refs.load(std::memory_order_relaxed), data.releases.load(std::memory_order_relaxed),
+		data.contended.load(std::memory_order_relaxed), data.peak_references.load(std::memory_order_relaxed));
+	m_slot.data = nullptr;
+	m_slot.exited = true;
+}
+template <typename T>
+inline dptr::detail::type_stats::block* dptr::detail::type_stats::this_thread_block()
+{
+	thread_local thread_slot slot{nullptr, false};
+	if(!slot.data && !slot.exited)
+	{
+		thread_local thread_block registered(of<T>(), slot);
+		slot.data = &registered.data;
+	}
+	return slot.data;
+}
+inline void dptr::detail::type_stats::add(block& data, std::uint64_t add_refs, std::uint64_t releases, std::uint64_t contended, std::uint64_t references) noexcept
+{
+	data.add_refs.store(data.add_refs.load(std::memory_order_relaxed) + add_refs, std::memory_order_relaxed);
+	data.releases.store(data.releases.load(std::memory_order_relaxed) + releases, std::memory_order_relaxed);
+	if(contended) data.contended.store(data.contended.load(std::memory_order_relaxed) + contended, std::memory_order_relaxed);
+	if(references > data.peak_references.load(std::memory_order_relaxed))
+		data.peak_references.store(references, std::memory_order_relaxed);
+}
+inline void dptr::detail::type_stats::add_locked(std::uint64_t add_refs, std::uint64_t releases, std::uint64_t contended, std::uint64_t references)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	add(m_retired, add_refs, releases, contended, references);
+}
+template <typename T>
+inline void dptr::detail::type_stats::record_add_ref(bool contended, std::size_t references) noexcept
+{
+	using type = std::remove_cv_t<T>;
+	if(block* const data = this_thread_block<type>()) add(*data, 1u, 0u, contended ? 1u : 0u, references);
+	else of<type>().add_locked(1u, 0u, contended ? 1u : 0u, references);
+}
+template <typename T>
+inline void dptr::detail::type_stats::record_release(bool contended) noexcept
+{
+	using type = std::remove_cv_t<T>;
+	if(block* const data = this_thread_block<type>()) add(*data, 0u, 1u, contended ? 1u : 0u, 0u);
+	else of<type>().add_locked(0u, 1u, contended ? 1u : 0u, 0u);
+}
+inline void dptr::detail::type_stats::collect(std::uint64_t& add_refs, std::uint64_t& releases, std::uint64_t& contended, std::uint64_t& peak_references)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	add_refs = m_retired.add_refs.load(std::memory_order_relaxed);
+	releases = m_retired.releases.load(std::memory_order_relaxed);
+	contended = m_retired.contended.load(std::memory_order_relaxed);
+	peak_references = m_retired.peak_references.load(std::memory_order_relaxed);
+	for(const block* data = m_blocks; data; data = data->next)
+	{
+		add_refs += data->add_refs.load(std::memory_order_relaxed);
+		releases += data->releases.load(std::memory_order_relaxed);
+		contended += data->contended.load(std::memory_order_relaxed);
+		const std::uint64_t peak = data->peak_references.load(std::memory_order_relaxed);
+		if(peak > peak_references) peak_references = peak;
+	}
+}
+
+template <typename T>
+inline dptr::dependency_stats dptr::stats_of()
+{
+	detail::type_stats& stats = detail::type_stats::of<std::remove_cv_t<T>>();
+	dependency_stats result{stats.type_name(), stats.is_atomic(), 0u, 0u, 0u, 0u};
+	stats.collect(result.add_refs, result.releases, result.contended, result.peak_references);
+	return result;
+}
+template <typename visitor_t>
+inline void dptr::for_each_stats(visitor_t&& visitor)
+{
+	detail::type_stats::visit([&](detail::type_stats& stats)
+	{
+		dependency_stats result{stats.type_name(), stats.is_atomic(), 0u, 0u, 0u, 0u};
+		stats.collect(result.add_refs, result.releases, result.contended, result.peak_references);
+		visitor(static_cast<const dependency_stats&>(result));
+	});
+}
+inline void dptr::dump_stats(std::ostream& stream)
+{
+	stream << "type,atomic,add_refs,releases,contended,peak_references\n";
+	for_each_stats([&](const dependency_stats& stats)
+	{
+		stream << (stats.type_name ? stats.type_name : "?") << ',' << stats.atomic << ',' << stats.add_refs << ',' << stats.releases << ','
+			<< stats.contended << ',' << stats.peak_references << '\n';
+	});
+	stream.flush();
+}
+#else
+inline void dptr::dump_stats(std::ostream&)
+{
+}
+#endif
+
+// --- dependency_pointer_impl
+template <typename T>
+DPTR_CONSTEXPR inline dptr::detail::dependency_pointer_impl<T>::dependency_pointer_impl() noexcept :
+	intrusive_ptr<T>(),
+	holder_tracker(),
+	m_borrows()
+{
+}
+template <typename T>
+DPTR_CONSTEXPR inline dptr::detail::dependency_pointer_impl<T>::dependency_pointer_impl(T* ptr, bool add_ref, source_site site) :
+	intrusive_ptr<T>(ptr, add_ref),
+	holder_tracker(),
+	m_borrows()
+{
+	retrack(site);
+}
+template <typename T>
+DPTR_CONSTEXPR inline dptr::detail::dependency_pointer_impl<T>::dependency_pointer_impl(const dependency_pointer_impl& other, source_site site) :
+	intrusive_ptr<T>(other),
+	holder_tracker(),
+	m_borrows()
+{
+	retrack(site);
+}
+template <typename T>
+template <typename U, typename>
+DPTR_CONSTEXPR inline dptr::detail::dependency_pointer_impl<T>::dependency_pointer_impl(const dependency_pointer_impl<U>& other, source_site site) :
+	intrusive_ptr<T>(other),
+	holder_tracker(),
+	m_borrows()
+{
+	retrack(site);
+}
+template <typename T>
+DPTR_CONSTEXPR inline dptr::detail::dependency_pointer_impl<T>::dependency_pointer_impl(dependency_pointer_impl&& other) noexcept :
+	intrusive_ptr<T>(),
+	holder_tracker(),
+	m_borrows()
+{
+	DPTR_ASSERT(!other.is_borrowed(), "[dptr::detail::dependency_pointer_impl::dependency_pointer_impl(move ctor)]: The moved-from pointer was still borrowed by dependency_refs.");
+	intrusive_ptr<T>::swap(other);
+	retrack(other.holder_tracker::site());
+	other.untrack();
+}
+template <typename T>
+template <typename U, typename>
+DPTR_CONSTEXPR inline dptr::detail::dependency_pointer_impl<T>::dependency_pointer_impl(dependency_pointer_impl<U>&& other) noexcept :
+	intrusive_ptr<T>(std::move(static_cast<intrusive_ptr<U>&>(other))),
+	holder_tracker(),
+	m_borrows()
+{
+	DPTR_ASSERT(!other.is_borrowed(), "[dptr::detail::dependency_pointer_impl::dependency_pointer_impl(move ctor)]: The moved-from pointer was still borrowed by dependency_refs.");
+	retrack(other.holder_tracker::site());
+	other.untrack();
+}
+template <typename T>
+DPTR_CONSTEXPR inline dptr::detail::dependency_pointer_impl<T>& dptr::detail::dependency_pointer_impl<T>::operator=(const dependency_pointer_impl& other)
+{
+	DPTR_ASSERT(!is_borrowed(), "[dptr::detail::dependency_pointer_impl::operator=(copy)]: The assigned pointer was still borrowed by dependency_refs.");
+	intrusive_ptr<T>::operator=(other);
+	retrack(other.holder_tracker::site());
+	return *this;
+}
+template <typename T>
+DPTR_CONSTEXPR inline dptr::detail::dependency_pointer_impl<T>& dptr::detail::dependency_pointer_impl<T>::operator=(dependency_pointer_impl&& other) noexcept
+{
+	DPTR_ASSERT(!is_borrowed(), "[dptr::detail::dependency_pointer_impl::operator=(move)]: The assigned pointer was still borrowed by dependency_refs.");
+	DPTR_ASSERT(!other.is_borrowed(), "[dptr::detail::dependency_pointer_impl::operator=(move)]: The moved-from pointer was still borrowed by dependency_refs.");
+	const source_site site = other.holder_tracker::site();
+	intrusive_ptr<T>::operator=(std::move(other));
+	other.retrack(site);
+	retrack(site);
 	return *this;
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<true, forbidden_ops>& dptr::detail::guarded_dependency_impl<true, forbidden_ops>::operator=(guarded_dependency_impl&& other) noexcept
+template <typename T>
+DPTR_CONSTEXPR inline dptr::detail::dependency_pointer_impl<T>& dptr::detail::dependency_pointer_impl<T>::operator=(T* ptr)
 {
-	// object stays at the same address => do not modify counter
-	// if there are still references, moving from the object causes undefined behaviour
-	if constexpr(forbidden_ops & dependency_op::move_from)
-		DPTR_ASSERT(other.m_counter.load(std::memory_order_relaxed) == 0ull, "[dptr::detail::guarded_dependency_impl::operator=(move)]: There were still (now invalid!) pointers referencing the moved-from object.");
-	if constexpr(forbidden_ops & dependency_op::move_assign)
-		DPTR_ASSERT(m_counter.load(std::memory_order_relaxed) == 0ull, "[dptr::detail::guarded_dependency_impl::operator=(move)]: There were still (now possibly invalid!) pointers referencing the assigned object.");
+	DPTR_ASSERT(!is_borrowed(), "[dptr::detail::dependency_pointer_impl::operator=(T*)]: The assigned pointer was still borrowed by dependency_refs.");
+	intrusive_ptr<T>::operator=(ptr);
+	// operators cannot take a defaulted site parameter, use reset to record the site
+	retrack(source_site{});
 	return *this;
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<true, forbidden_ops>::~guarded_dependency_impl()
+template <typename T>
+DPTR_CONSTEXPR inline dptr::detail::dependency_pointer_impl<T>::~dependency_pointer_impl()
 {
-	if constexpr(forbidden_ops & dependency_op::destroy)
-		DPTR_ASSERT(m_counter.load(std::memory_order_relaxed) == 0ull, "[dptr::detail::guarded_dependency_impl::~guarded_dependency_impl]: There were still (now dangling!) pointers referencing this object.");
+	// checked here instead of in the class, where T may still be incomplete
+	static_assert(is_checked_dependency_v<T>, "[dptr::detail::dependency_pointer_impl]: dependency_ptr can only be used with types deriving guarded_dependency or arena_dependency or side table dependencies.");
+	DPTR_ASSERT(!is_borrowed(), "[dptr::detail::dependency_pointer_impl::~dependency_pointer_impl]: There were still (now dangling!) dependency_refs borrowing from this pointer.");
+}
+template <typename T>
+DPTR_CONSTEXPR inline void dptr::detail::dependency_pointer_impl<T>::reset()
+{
+	DPTR_ASSERT(!is_borrowed(), "[dptr::detail::dependency_pointer_impl::reset]: The pointer was still borrowed by dependency_refs.");
+	intrusive_ptr<T>::reset();
+	untrack();
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline void dptr::detail::guarded_dependency_impl<true, forbidden_ops>::inc() const noexcept
+template <typename T>
+DPTR_CONSTEXPR inline void dptr::detail::dependency_pointer_impl<T>::reset(T* ptr, source_site site)
+{
+	DPTR_ASSERT(!is_borrowed(), "[dptr::detail::dependency_pointer_impl::reset]: The pointer was still borrowed by dependency_refs.");
+	intrusive_ptr<T>::reset(ptr);
+	retrack(site);
+}
+template <typename T>
+DPTR_CONSTEXPR inline void dptr::detail::dependency_pointer_impl<T>::reset(T* ptr, bool add_ref, source_site site)
 {
-	m_counter.fetch_add(1ull, std::memory_order::memory_order_relaxed);
+	DPTR_ASSERT(!is_borrowed(), "[dptr::detail::dependency_pointer_impl::reset]: The pointer was still borrowed by dependency_refs.");
+	intrusive_ptr<T>::reset(ptr, add_ref);
+	retrack(site);
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline void dptr::detail::guarded_dependency_impl<true, forbidden_ops>::dec() const noexcept
+template <typename T>
+DPTR_CONSTEXPR inline T* dptr::detail::dependency_pointer_impl<T>::detach() noexcept
 {
-	m_counter.fetch_sub(1ull, std::memory_order::memory_order_relaxed);
+	DPTR_ASSERT(!is_borrowed(), "[dptr::detail::dependency_pointer_impl::detach]: The pointer was still borrowed by dependency_refs.");
+	untrack();
+	return intrusive_ptr<T>::detach();
+}
+template <typename T>
+DPTR_CONSTEXPR inline void dptr::detail::dependency_pointer_impl<T>::swap(dependency_pointer_impl& rhs) noexcept
+{
+	DPTR_ASSERT(!is_borrowed() && !rhs.is_borrowed(), "[dptr::detail::dependency_pointer_impl::swap]: One of the swapped pointers was still borrowed by dependency_refs.");
+	const source_site lhs_site = holder_tracker::site();
+	const source_site rhs_site = rhs.holder_tracker::site();
+	intrusive_ptr<T>::swap(rhs);
+	retrack(rhs_site);
+	rhs.retrack(lhs_site);
+}
+template <typename T>
+DPTR_CONSTEXPR inline bool dptr::detail::dependency_pointer_impl<T>::is_borrowed() const noexcept
+{
+	// dependency_refs are not counted at compile time
+	if(is_constant_evaluated()) return false;
+	return m_borrows.load() != 0ull;
+}
+template <typename T>
+DPTR_CONSTEXPR inline void dptr::detail::dependency_pointer_impl<T>::retrack(source_site site) noexcept
+{
+	#if DPTR_TRACK_HOLDERS
+	T* const ptr = intrusive_ptr<T>::get();
+	holder_tracker::track(this, dependency_address(ptr), tracked_object_of(ptr), site);
+	#else
+	(void)site;
+	#endif
+}
+
+// --- borrow_counter
+template <bool atomic>
+inline void dptr::detail::borrow_counter::inc() noexcept
+{
+	if constexpr(atomic)
+		m_count.fetch_add(1u, std::memory_order_relaxed);
+	else
+		m_count.store(m_count.load(std::memory_order_relaxed) + 1u, std::memory_order_relaxed);
+}
+template <bool atomic>
+inline void dptr::detail::borrow_counter::dec() noexcept
+{
+	if constexpr(atomic)
+		m_count.fetch_sub(1u, std::memory_order_relaxed);
+	else
+		m_count.store(m_count.load(std::memory_order_relaxed) - 1u, std::memory_order_relaxed);
+}
+inline std::size_t dptr::detail::borrow_counter::load() const noexcept
+{
+	return m_count.load(std::memory_order_relaxed);
+}
+
+// --- dependency_ref_impl
+template <typename T>
+inline dptr::detail::dependency_ref_impl<T>::dependency_ref_impl() noexcept :
+	m_ptr(nullptr),
+	m_borrows(nullptr)
+{
+}
+template <typename T>
+inline dptr::detail::dependency_ref_impl<T>::dependency_ref_impl(T* ptr, borrow_counter* borrows) noexcept :
+	m_ptr(ptr),
+	m_borrows(borrows)
+{
+	if(m_borrows) m_borrows->template inc<is_ref_counter_atomic<T>::value>();
+}
+template <typename T>
+template <typename U, typename>
+inline dptr::detail::dependency_ref_impl<T>::dependency_ref_impl(const dependency_pointer_impl<U>& source) noexcept :
+	dependency_ref_impl(source.get(), &source.m_borrows)
+{
+}
+template <typename T>
+inline dptr::detail::dependency_ref_impl<T>::dependency_ref_impl(const dependency_ref_impl& other) noexcept :
+	dependency_ref_impl(other.m_ptr, other.m_borrows)
+{
+}
+template <typename T>
+template <typename U, typename>
+inline dptr::detail::dependency_ref_impl<T>::dependency_ref_impl(const dependency_ref_impl<U>& other) noexcept :
+	dependency_ref_impl(other.m_ptr, other.m_borrows)
+{
+}
+template <typename T>
+inline dptr::detail::dependency_ref_impl<T>& dptr::detail::dependency_ref_impl<T>::operator=(const dependency_ref_impl& other) noexcept
+{
+	if(other.m_borrows) other.m_borrows->template inc<is_ref_counter_atomic<T>::value>();
+	if(m_borrows) m_borrows->template dec<is_ref_counter_atomic<T>::value>();
+	m_ptr = other.m_ptr;
+	m_borrows = other.m_borrows;
+	return *this;
+}
+template <typename T>
+inline dptr::detail::dependency_ref_impl<T>::~dependency_ref_impl()
+{
+	if(m_borrows) m_borrows->template dec<is_ref_counter_atomic<T>::value>();
+}
+template <typename T>
+inline T& dptr::detail::dependency_ref_impl<T>::operator*() const noexcept
+{
+	DPTR_ASSERT(m_ptr, "[dptr::detail::dependency_ref_impl::operator*]: nullptr access.");
+	return *m_ptr;
+}
+template <typename T>
+inline T* dptr::detail::dependency_ref_impl<T>::operator->() const noexcept
+{
+	DPTR_ASSERT(m_ptr, "[dptr::detail::dependency_ref_impl::operator->]: nullptr access.");
+	return m_ptr;
+}
+template <typename T>
+inline T* dptr::detail::dependency_ref_impl<T>::get() const noexcept
+{
+	return m_ptr;
+}
+template <typename T>
+inline dptr::detail::dependency_ref_impl<T>::operator bool() const noexcept
+{
+	return m_ptr;
+}
+template <typename T>
+inline dptr::detail::dependency_ref_impl<T>::operator T*() const noexcept
+{
+	return m_ptr;
 }
 
-// --- non atomic version
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<false, forbidden_ops>::guarded_dependency_impl() noexcept :
-	m_counter(0ull)
+inline constexpr dptr::dependency_op_flags dptr::operator~(dependency_op op) noexcept
 {
-	// new object at new address, init counter to 0
+	return ~static_cast<dependency_op_flags>(op);
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<false, forbidden_ops>::guarded_dependency_impl(const guarded_dependency_impl& other) noexcept :
-	m_counter(0ull)
+
+inline constexpr dptr::dependency_op_flags dptr::operator|(dependency_op lhs, dependency_op rhs) noexcept
 {
-	// new object at new address, init counter to 0
+	return static_cast<dependency_op_flags>(lhs) | static_cast<dependency_op_flags>(rhs);
+}
+
+constexpr dptr::dependency_op_flags dptr::operator|(dependency_op_flags lhs, dependency_op rhs) noexcept
+{
+	return lhs | static_cast<dependency_op_flags>(rhs);
+}
+
+constexpr dptr::dependency_op_flags dptr::operator|(dependency_op lhs, dependency_op_flags rhs) noexcept
+{
+	return static_cast<dependency_op_flags>(lhs) | rhs;
+}
+
+inline constexpr dptr::dependency_op_flags dptr::operator&(dependency_op lhs, dependency_op rhs) noexcept
+{
+	return static_cast<dependency_op_flags>(lhs) & static_cast<dependency_op_flags>(rhs);
+}
+
+constexpr dptr::dependency_op_flags dptr::operator&(dependency_op_flags lhs, dependency_op rhs) noexcept
+{
+	return lhs & static_cast<dependency_op_flags>(rhs);
+}
+
+constexpr dptr::dependency_op_flags dptr::operator&(dependency_op lhs, dependency_op_flags rhs) noexcept
+{
+	return static_cast<dependency_op_flags>(lhs) & rhs;
+}
+
+inline constexpr dptr::dependency_op_flags dptr::operator^(dependency_op lhs, dependency_op rhs) noexcept
+{
+	return static_cast<dependency_op_flags>(lhs) ^ static_cast<dependency_op_flags>(rhs);
+}
+
+constexpr dptr::dependency_op_flags dptr::operator^(dependency_op_flags lhs, dependency_op rhs) noexcept
+{
+	return lhs ^ static_cast<dependency_op_flags>(rhs);
+}
+
+constexpr dptr::dependency_op_flags dptr::operator^(dependency_op lhs, dependency_op_flags rhs) noexcept
+{
+	return static_cast<dependency_op_flags>(lhs) ^ rhs;
+}
+
+inline constexpr dptr::dependency_op_flags& dptr::operator|=(dependency_op_flags& lhs, dependency_op rhs) noexcept
+{
+	return lhs |= static_cast<dependency_op_flags>(rhs);
+}
+
+inline constexpr dptr::dependency_op_flags& dptr::operator&=(dependency_op_flags& lhs, dependency_op rhs) noexcept
+{
+	return lhs &= static_cast<dependency_op_flags>(rhs);
+}
+
+inline constexpr dptr::dependency_op_flags& dptr::operator^=(dependency_op_flags& lhs, dependency_op rhs) noexcept
+{
+	return lhs ^= static_cast<dependency_op_flags>(rhs);
+}
+
+// --- counter policies
+inline dptr::default_counter<true>::default_counter() noexcept :
+	m_count(0ull)
+{
+}
+inline void dptr::default_counter<true>::inc() noexcept
+{
+	m_count.fetch_add(1ull, std::memory_order_relaxed);
+}
+inline void dptr::default_counter<true>::dec() noexcept
+{
+	m_count.fetch_sub(1ull, std::memory_order_relaxed);
+}
+inline bool dptr::default_counter<true>::try_inc() noexcept
+{
+	std::size_t expected = m_count.load(std::memory_order_relaxed);
+	return m_count.compare_exchange_strong(expected, expected + 1ull, std::memory_order_relaxed);
+}
+inline bool dptr::default_counter<true>::try_dec() noexcept
+{
+	std::size_t expected = m_count.load(std::memory_order_relaxed);
+	return m_count.compare_exchange_strong(expected, expected - 1ull, std::memory_order_relaxed);
+}
+inline std::size_t dptr::default_counter<true>::load() const noexcept
+{
+	return m_count.load(std::memory_order_relaxed);
+}
+
+DPTR_CONSTEXPR inline dptr::default_counter<false>::default_counter() noexcept :
+	m_count(0ull)
+{
+}
+DPTR_CONSTEXPR inline void dptr::default_counter<false>::inc() noexcept
+{
+	++m_count;
+}
+DPTR_CONSTEXPR inline void dptr::default_counter<false>::dec() noexcept
+{
+	--m_count;
+}
+DPTR_CONSTEXPR inline std::size_t dptr::default_counter<false>::load() const noexcept
+{
+	return m_count;
+}
+
+inline std::size_t dptr::detail::this_thread_index() noexcept
+{
+	static std::atomic<std::size_t> next_index{0ull};
+	thread_local const std::size_t index = next_index.fetch_add(1ull, std::memory_order_relaxed);
+	return index;
+}
+
+template <std::size_t shard_count>
+inline dptr::sharded_counter<shard_count>::sharded_counter() noexcept
+{
+	for(auto& s : m_shards)
+		s.count.store(0ull, std::memory_order_relaxed);
+}
+template <std::size_t shard_count>
+inline void dptr::sharded_counter<shard_count>::inc() noexcept
+{
+	m_shards[detail::this_thread_index() & (shard_count - 1u)].count.fetch_add(1ull, std::memory_order_relaxed);
+}
+template <std::size_t shard_count>
+inline void dptr::sharded_counter<shard_count>::dec() noexcept
+{
+	m_shards[detail::this_thread_index() & (shard_count - 1u)].count.fetch_sub(1ull, std::memory_order_relaxed);
+}
+template <std::size_t shard_count>
+inline std::size_t dptr::sharded_counter<shard_count>::load() const noexcept
+{
+	std::size_t sum = 0ull;
+	for(const auto& s : m_shards)
+		sum += s.count.load(std::memory_order_relaxed);
+	return sum;
+}
+
+template <bool atomic, typename count_type>
+inline dptr::compact_counter<atomic, count_type>::compact_counter() noexcept :
+	m_count(0u)
+{
+}
+template <bool atomic, typename count_type>
+inline void dptr::compact_counter<atomic, count_type>::inc() noexcept
+{
+	constexpr count_type max = std::numeric_limits<count_type>::max();
+	if constexpr(atomic)
+	{
+		const count_type previous = m_count.fetch_add(1u, std::memory_order_relaxed);
+		DPTR_ASSERT(previous != max, "[dptr::compact_counter::inc]: Reference count overflow, use a wider count_type.");
+	}
+	else
+	{
+		DPTR_ASSERT(m_count != max, "[dptr::compact_counter::inc]: Reference count overflow, use a wider count_type.");
+		++m_count;
+	}
+}
+template <bool atomic, typename count_type>
+inline void dptr::compact_counter<atomic, count_type>::dec() noexcept
+{
+	if constexpr(atomic)
+		m_count.fetch_sub(1u, std::memory_order_relaxed);
+	else
+		--m_count;
+}
+template <bool atomic, typename count_type>
+inline std::size_t dptr::compact_counter<atomic, count_type>::load() const noexcept
+{
+	if constexpr(atomic)
+		return m_count.load(std::memory_order_relaxed);
+	else
+		return m_count;
+}
+
+template <typename counter_policy>
+inline void dptr::isolated_counter<counter_policy>::inc() noexcept
+{
+	m_counter.inc();
+}
+template <typename counter_policy>
+inline void dptr::isolated_counter<counter_policy>::dec() noexcept
+{
+	m_counter.dec();
+}
+template <typename counter_policy>
+inline std::size_t dptr::isolated_counter<counter_policy>::load() const noexcept
+{
+	return m_counter.load();
+}
+
+inline std::atomic<std::uint32_t>& dptr::detail::sampling_rate_storage() noexcept
+{
+	static std::atomic<std::uint32_t> rate{DPTR_SAMPLING_RATE};
+	return rate;
+}
+inline void dptr::set_sampling_rate(std::uint32_t rate) noexcept
+{
+	detail::sampling_rate_storage().store(rate, std::memory_order_relaxed);
+}
+inline std::uint32_t dptr::sampling_rate() noexcept
+{
+	return detail::sampling_rate_storage().load(std::memory_order_relaxed);
+}
+inline bool dptr::detail::sample() noexcept
+{
+	const std::uint32_t rate = sampling_rate();
+	if(rate <= 1u)
+		return rate == 1u;
+	// xorshift32, seeded differently per thread
+	thread_local std::uint32_t state = static_cast<std::uint32_t>(this_thread_index()) * 0x9E3779B9u + 0x6A09E667u;
+	state ^= state << 13u;
+	state ^= state >> 17u;
+	state ^= state << 5u;
+	return state % rate == 0u;
+}
+
+template <typename counter_policy>
+inline dptr::sampled_counter<counter_policy>::sampled_counter() noexcept :
+	m_counter(),
+	m_sampled(detail::sample())
+{
+}
+template <typename counter_policy>
+inline void dptr::sampled_counter<counter_policy>::inc() noexcept
+{
+	if(m_sampled) m_counter.inc();
+}
+template <typename counter_policy>
+inline void dptr::sampled_counter<counter_policy>::dec() noexcept
+{
+	if(m_sampled) m_counter.dec();
+}
+template <typename counter_policy>
+inline std::size_t dptr::sampled_counter<counter_policy>::load() const noexcept
+{
+	return m_sampled ? m_counter.load() : 0ull;
+}
+template <typename counter_policy>
+inline bool dptr::sampled_counter<counter_policy>::sampled() const noexcept
+{
+	return m_sampled;
+}
+
+// --- guarded dependency
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::guarded_dependency_impl() noexcept
+{
+	// new object at new address, counter starts at 0
+}
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::guarded_dependency_impl(const guarded_dependency_impl& other) noexcept
+{
+	// new object at new address, counter starts at 0
 	if constexpr(forbidden_ops & dependency_op::copy_from)
-		DPTR_ASSERT(m_counter == 0ull, "[dptr::detail::guarded_dependency_impl::guarded_dependency_impl(copy ctor)]: There were still (now invalid!) pointers referencing the copied-from object.");
+		DPTR_ASSERT_UNREFERENCED(dependency_op::copy_from, other.count(), &other, "[dptr::detail::guarded_dependency_impl::guarded_dependency_impl(copy ctor)]: There were still (now invalid!) pointers referencing the copied-from object.");
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<false, forbidden_ops>::guarded_dependency_impl(guarded_dependency_impl&& other) noexcept :
-	m_counter(0ull)
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::guarded_dependency_impl(guarded_dependency_impl&& other) noexcept
 {
-	// new object at new address, init counter to 0
+	// new object at new address, counter starts at 0
 	// if there are still references, moving from the object causes undefined behaviour
 	if constexpr(forbidden_ops & dependency_op::move_from)
-		DPTR_ASSERT(other.m_counter == 0ull, "[dptr::detail::guarded_dependency_impl::guarded_dependency_impl(move ctor)]: There were still (now invalid!) pointers referencing the moved-from object.");
+		DPTR_ASSERT_UNREFERENCED(dependency_op::move_from, other.count(), &other, "[dptr::detail::guarded_dependency_impl::guarded_dependency_impl(move ctor)]: There were still (now invalid!) pointers referencing the moved-from object.");
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<false, forbidden_ops>& dptr::detail::guarded_dependency_impl<false, forbidden_ops>::operator=(const guarded_dependency_impl& other) noexcept
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>& dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::operator=(const guarded_dependency_impl& other) noexcept
 {
 	// object stays at the same address => do not modify counter
 	if constexpr(forbidden_ops & dependency_op::copy_from)
-		DPTR_ASSERT(other.m_counter == 0ull, "[dptr::detail::guarded_dependency_impl::operator=(copy)]: There were still (now invalid!) pointers referencing the copied-from object.");
+		DPTR_ASSERT_UNREFERENCED(dependency_op::copy_from, other.count(), &other, "[dptr::detail::guarded_dependency_impl::operator=(copy)]: There were still (now invalid!) pointers referencing the copied-from object.");
 	if constexpr(forbidden_ops & dependency_op::copy_assign)
-		DPTR_ASSERT(m_counter == 0ull, "[dptr::detail::guarded_dependency_impl::operator=(copy)]: There were still (now possibly invalid!) pointers referencing the assigned object.");
+		DPTR_ASSERT_UNREFERENCED(dependency_op::copy_assign, count(), this, "[dptr::detail::guarded_dependency_impl::operator=(copy)]: There were still (now possibly invalid!) pointers referencing the assigned object.");	
 	return *this;
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<false, forbidden_ops>& dptr::detail::guarded_dependency_impl<false, forbidden_ops>::operator=(guarded_dependency_impl&& other) noexcept
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>& dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::operator=(guarded_dependency_impl&& other) noexcept
 {
 	// object stays at the same address => do not modify counter
 	// if there are still references, moving from the object causes undefined behaviour
 	if constexpr(forbidden_ops & dependency_op::move_from)
-		DPTR_ASSERT(other.m_counter == 0ull, "[dptr::detail::guarded_dependency_impl::operator=(move)]: There were still (now invalid!) pointers referencing the moved-from object.");
+		DPTR_ASSERT_UNREFERENCED(dependency_op::move_from, other.count(), &other, "[dptr::detail::guarded_dependency_impl::operator=(move)]: There were still (now invalid!) pointers referencing the moved-from object.");
 	if constexpr(forbidden_ops & dependency_op::move_assign)
-		DPTR_ASSERT(m_counter == 0ull, "[dptr::detail::guarded_dependency_impl::operator=(move)]: There were still (now possibly invalid!) pointers referencing the assigned object.");
+		DPTR_ASSERT_UNREFERENCED(dependency_op::move_assign, count(), this, "[dptr::detail::guarded_dependency_impl::operator=(move)]: There were still (now possibly invalid!) pointers referencing the assigned object.");
 	return *this;
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline dptr::detail::guarded_dependency_impl<false, forbidden_ops>::~guarded_dependency_impl()
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::~guarded_dependency_impl()
 {
 	if constexpr(forbidden_ops & dependency_op::destroy)
-		DPTR_ASSERT(m_counter == 0ull, "[dptr::detail::guarded_dependency_impl::~guarded_dependency_impl]: There were still (now dangling!) pointers referencing this object.");
+		DPTR_ASSERT_UNREFERENCED(dependency_op::destroy, count(), this, "[dptr::detail::guarded_dependency_impl::~guarded_dependency_impl]: There were still (now dangling!) pointers referencing this object.");
+}
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline void dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::inc() const noexcept
+{
+	m_counter.inc();
+}
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline void dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::dec() const noexcept
+{
+	m_counter.dec();
+}
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline bool dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::try_inc() const noexcept
+{
+	if constexpr(has_try_update<counter_policy>::value)
+		return m_counter.try_inc();
+	else
+	{
+		m_counter.inc();
+		return true;
+	}
+}
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline bool dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::try_dec() const noexcept
+{
+	if constexpr(has_try_update<counter_policy>::value)
+		return m_counter.try_dec();
+	else
+	{
+		m_counter.dec();
+		return true;
+	}
+}
+template <bool atomic, dptr::dependency_op_flags forbidden_ops, typename counter_policy>
+DPTR_CONSTEXPR inline std::size_t dptr::detail::guarded_dependency_impl<atomic, forbidden_ops, counter_policy>::count() const noexcept
+{
+	return m_counter.load();
+}
+
+// --- guarded arena
+template <bool atomic, typename counter_policy>
+inline dptr::detail::guarded_arena_impl<atomic, counter_policy>::binding::binding(const guarded_arena_impl& arena) noexcept :
+	m_previous(current_storage())
+{
+	current_storage() = &arena;
+}
+template <bool atomic, typename counter_policy>
+inline dptr::detail::guarded_arena_impl<atomic, counter_policy>::binding::~binding()
+{
+	current_storage() = m_previous;
+}
+template <bool atomic, typename counter_policy>
+inline dptr::detail::guarded_arena_impl<atomic, counter_policy>::~guarded_arena_impl()
+{
+	DPTR_ASSERT_UNREFERENCED(dependency_op::destroy, m_counter.load(), this, "[dptr::detail::guarded_arena_impl::~guarded_arena_impl]: There were still (now dangling!) pointers referencing objects of this arena.");
+	DPTR_ASSERT(current_storage() != this, "[dptr::detail::guarded_arena_impl::~guarded_arena_impl]: The arena was destroyed while it was still bound.");
+}
+template <bool atomic, typename counter_policy>
+inline typename dptr::detail::guarded_arena_impl<atomic, counter_policy>::binding dptr::detail::guarded_arena_impl<atomic, counter_policy>::bind() const noexcept
+{
+	return binding(*this);
+}
+template <bool atomic, typename counter_policy>
+inline std::size_t dptr::detail::guarded_arena_impl<atomic, counter_policy>::references() const noexcept
+{
+	return m_counter.load();
+}
+template <bool atomic, typename counter_policy>
+inline void dptr::detail::guarded_arena_impl<atomic, counter_policy>::assert_unreferenced() const noexcept
+{
+	DPTR_ASSERT_UNREFERENCED(0u, m_counter.load(), this, "[dptr::detail::guarded_arena_impl::assert_unreferenced]: There were still pointers referencing objects of this arena.");
+}
+template <bool atomic, typename counter_policy>
+inline const dptr::detail::guarded_arena_impl<atomic, counter_policy>* dptr::detail::guarded_arena_impl<atomic, counter_policy>::current() noexcept
+{
+	return current_storage();
+}
+template <bool atomic, typename counter_policy>
+inline const dptr::detail::guarded_arena_impl<atomic, counter_policy>*& dptr::detail::guarded_arena_impl<atomic, counter_policy>::current_storage() noexcept
+{
+	thread_local const guarded_arena_impl* arena = nullptr;
+	return arena;
+}
+
+template <bool atomic, typename counter_policy>
+inline dptr::detail::arena_dependency_impl<atomic, counter_policy>::arena_dependency_impl() noexcept :
+	m_arena(arena_type::current())
+{
+	DPTR_ASSERT(m_arena, "[dptr::detail::arena_dependency_impl::arena_dependency_impl]: No arena is bound on this thread, use guarded_arena::bind or pass the arena.");
+}
+template <bool atomic, typename counter_policy>
+inline dptr::detail::arena_dependency_impl<atomic, counter_policy>::arena_dependency_impl(const arena_type& arena) noexcept :
+	m_arena(&arena)
+{
+}
+template <bool atomic, typename counter_policy>
+inline dptr::detail::arena_dependency_impl<atomic, counter_policy>::arena_dependency_impl(const arena_dependency_impl& other) noexcept :
+	m_arena(arena_type::current() ? arena_type::current() : other.m_arena)
+{
+}
+
+// --- side table
+inline std::size_t dptr::detail::side_table::hash(const void* object) noexcept
+{
+	// objects are at least 4 byte apart in practice, fibonacci hashing spreads the remaining bits
+	const std::uint64_t value = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(object) >> 2u);
+	return static_cast<std::size_t>((value * 0x9E3779B97F4A7C15ull) >> 16u);
+}
+inline dptr::detail::side_table::shard& dptr::detail::side_table::shard_of(std::size_t hash) noexcept
+{
+	static shard shards[DPTR_SIDE_TABLE_SHARDS];
+	return shards[hash & (DPTR_SIDE_TABLE_SHARDS - 1u)];
+}
+inline std::size_t dptr::detail::side_table::add_ref(const void* object) noexcept
+{
+	const std::size_t h = hash(object);
+	shard& s = shard_of(h);
+	s.lock();
+	const std::size_t count = s.add_ref(object, h);
+	s.unlock();
+	return count;
+}
+inline std::size_t dptr::detail::side_table::release(const void* object) noexcept
+{
+	const std::size_t h = hash(object);
+	shard& s = shard_of(h);
+	s.lock();
+	const std::size_t count = s.release(object, h);
+	s.unlock();
+	return count;
+}
+inline std::size_t dptr::detail::side_table::count(const void* object) noexcept
+{
+	const std::size_t h = hash(object);
+	shard& s = shard_of(h);
+	s.lock();
+	const std::size_t count = s.count(object, h);
+	s.unlock();
+	return count;
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline void dptr::detail::guarded_dependency_impl<false, forbidden_ops>::inc() const noexcept
+inline void dptr::detail::side_table::shard::lock() noexcept
 {
-	++m_counter;
+	for(unsigned spins = 0u; m_locked.exchange(true, std::memory_order_acquire); ++spins)
+	{
+		while(m_locked.load(std::memory_order_relaxed))
+			if(++spins > 64u) std::this_thread::yield();
+	}
 }
-template <dptr::dependency_op_flags forbidden_ops>
-inline void dptr::detail::guarded_dependency_impl<false, forbidden_ops>::dec() const noexcept
+inline void dptr::detail::side_table::shard::unlock() noexcept
 {
-	--m_counter;
+	m_locked.store(false, std::memory_order_release);
+}
+inline std::size_t dptr::detail::side_table::shard::find(const void* key, std::size_t hash) const noexcept
+{
+	// the low hash bits select the shard, use the higher ones for the slot
+	std::size_t slot = (hash / DPTR_SIDE_TABLE_SHARDS) & m_mask;
+	while(m_entries[slot].key && m_entries[slot].key != key)
+		slot = (slot + 1u) & m_mask;
+	return slot;
+}
+inline std::size_t dptr::detail::side_table::shard::add_ref(const void* key, std::size_t hash) noexcept
+{
+	// keep the load factor <= 3/4
+	if(4u * (m_size + 1u) > 3u * (m_mask + 1u) || !m_entries) grow();
+	entry& e = m_entries[find(key, hash)];
+	if(!e.key)
+	{
+		e.key = key;
+		e.count = 0u;
+		++m_size;
+	}
+	return ++e.count;
+}
+inline std::size_t dptr::detail::side_table::shard::release(const void* key, std::size_t hash) noexcept
+{
+	if(!m_entries) return 0u;
+	const std::size_t slot = find(key, hash);
+	entry& e = m_entries[slot];
+	if(!e.key) return 0u;
+	const std::size_t count = --e.count;
+	if(count == 0u) erase(slot);
+	return count;
+}
+inline std::size_t dptr::detail::side_table::shard::count(const void* key, std::size_t hash) const noexcept
+{
+	if(!m_entries) return 0u;
+	const entry& e = m_entries[find(key, hash)];
+	return e.key ? e.count : 0u;
+}
+inline void dptr::detail::side_table::shard::grow() noexcept
+{
+	entry* const old_entries = m_entries;
+	const std::size_t old_capacity = old_entries ? m_mask + 1u : 0u;
+	const std::size_t capacity = old_capacity ? 2u * old_capacity : 16u;
+	// running out of memory in a debugging aid terminates (noexcept)
+	m_entries = new entry[capacity]();
+	m_mask = capacity - 1u;
+	for(std::size_t i = 0u; i < old_capacity; ++i)
+		if(old_entries[i].key)
+			m_entries[find(old_entries[i].key, hash(old_entries[i].key))] = old_entries[i];
+	delete[] old_entries;
+}
+inline void dptr::detail::side_table::shard::erase(std::size_t slot) noexcept
+{
+	// backward shift deletion: move following entries of the probe sequence into the gap, no tombstones needed
+	std::size_t gap = slot;
+	for(std::size_t next = (gap + 1u) & m_mask; m_entries[next].key; next = (next + 1u) & m_mask)
+	{
+		const std::size_t home = (hash(m_entries[next].key) / DPTR_SIDE_TABLE_SHARDS) & m_mask;
+		// entry may move if its home slot is not within (gap, next]
+		if(((next - home) & m_mask) >= ((next - gap) & m_mask))
+		{
+			m_entries[gap] = m_entries[next];
+			gap = next;
+		}
+	}
+	m_entries[gap].key = nullptr;
+	m_entries[gap].count = 0u;
+	--m_size;
 }
 
 // --- inc/dec functions
-template<bool atomic, dptr::dependency_op_flags forbidden_ops>
-void dptr::detail::intrusive_ptr_add_ref(const guarded_dependency_impl<atomic, forbidden_ops>* dep) noexcept
+template <typename T>
+inline const void* dptr::detail::dependency_address(const T* ptr) noexcept
 {
-	dep->inc();
+	if constexpr(is_guarded_dependency<T>::value)
+		return static_cast<const guarded_base_t<T>*>(ptr);
+	else if constexpr(is_arena_dependency<T>::value)
+		return static_cast<const typename T::arena_dependency_base*>(ptr);
+	else
+		return ptr;
 }
-template<bool atomic, dptr::dependency_op_flags forbidden_ops>
-void dptr::detail::intrusive_ptr_release(const guarded_dependency_impl<atomic, forbidden_ops>* dep) noexcept
+template <typename T>
+DPTR_CONSTEXPR inline void dptr::detail::intrusive_ptr_add_ref(const T* dep) noexcept
+{
+	if constexpr(dptr::side_table_dependency_v<T>)
+	{
+		[[maybe_unused]] const std::size_t count = side_table::add_ref(dep);
+		#if DPTR_COLLECT_STATS
+		// contention on the shard locks is not detected
+		type_stats::record_add_ref<T>(false, count);
+		#endif
+	}
+	else if constexpr(is_arena_dependency<T>::value)
+	{
+		const typename T::arena_dependency_base* const base = dep;
+		base->m_arena->m_counter.inc();
+		#if DPTR_COLLECT_STATS
+		// peak references are those of the whole arena
+		type_stats::record_add_ref<T>(false, base->m_arena->m_counter.load());
+		#endif
+	}
+	else
+	{
+		const guarded_base_t<T>* const base = dep;
+		#if DPTR_COLLECT_STATS
+		if(is_constant_evaluated())
+		{
+			base->inc();
+			return;
+		}
+		const bool contended = !base->try_inc();
+		if(contended) base->inc();
+		type_stats::record_add_ref<T>(contended, base->count());
+		#else
+		base->inc();
+		#endif
+	}
+}
+template <typename T>
+DPTR_CONSTEXPR inline void dptr::detail::intrusive_ptr_release(const T* dep) noexcept
+{
+	if constexpr(dptr::side_table_dependency_v<T>)
+	{
+		const std::size_t count = side_table::release(dep);
+		#if DPTR_COLLECT_STATS
+		type_stats::record_release<T>(false);
+		#endif
+		if(release_hook_state& hooks = release_hook_storage(); count == 0u && hooks.waiting.load(std::memory_order_relaxed) != 0u)
+			if(const release_hook hook = hooks.hook.load(std::memory_order_relaxed)) hook();
+	}
+	else if constexpr(is_arena_dependency<T>::value)
+	{
+		const typename T::arena_dependency_base* const base = dep;
+		base->m_arena->m_counter.dec();
+		#if DPTR_COLLECT_STATS
+		type_stats::record_release<T>(false);
+		#endif
+	}
+	else
+	{
+		const guarded_base_t<T>* const base = dep;
+		#if DPTR_COLLECT_STATS
+		if(is_constant_evaluated())
+		{
+			base->dec();
+			return;
+		}
+		const bool contended = !base->try_dec();
+		if(contended) base->dec();
+		type_stats::record_release<T>(contended);
+		#else
+		base->dec();
+		#endif
+		if constexpr(T::is_dep_ref_counter_atomic)
+		{
+			release_hook_state& hooks = release_hook_storage();
+			if(hooks.waiting.load(std::memory_order_relaxed) != 0u && base->count() == 0u)
+				if(const release_hook hook = hooks.hook.load(std::memory_order_relaxed)) hook();
+		}
+	}
+}
+template <typename T>
+std::size_t dptr::detail::reference_count(const T* dep) noexcept
+{
+	if constexpr(dptr::side_table_dependency_v<T>)
+		return side_table::count(dep);
+	else if constexpr(is_guarded_dependency<T>::value)
+		return static_cast<const guarded_base_t<T>*>(dep)->count();
+	else
+		return 0u;
+}
+template <typename T>
+inline void dptr::assert_unreferenced(const T& object)
+{
+	// references to arena dependencies are only known per arena
+	if constexpr(detail::is_checked_dependency_v<T> && !detail::is_arena_dependency<T>::value)
+		DPTR_ASSERT_UNREFERENCED(0u, detail::reference_count(&object), detail::dependency_address(&object), "[dptr::assert_unreferenced]: There were still pointers referencing the object.");
+	else
+		(void)object;
+}
+template <typename T>
+inline void dptr::checked_delete<T>::operator()(T* ptr) const
 {
-	dep->dec();
+	if(ptr) assert_unreferenced(*ptr);
+	delete ptr;
 }
 #pragma endregion
 #endif
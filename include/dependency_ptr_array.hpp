@@ -0,0 +1,430 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_DEPENDENCY_PTR_ARRAY_H_
+#define _DPTR_DEPENDENCY_PTR_ARRAY_H_
+
+#include "dependency_ptr.hpp"
+
+#include <initializer_list>
+#include <iterator>
+#include <unordered_map>
+#include <vector>
+
+namespace dptr
+{
+	namespace detail
+	{
+		#pragma region target_counts
+		// Counts how often each distinct target is stored in a container. The container holds one reference
+		// per distinct target, so copying or destroying it costs one counter update per distinct target.
+		template <typename T, bool counted>
+		class target_counts;
+
+		template <typename T>
+		class target_counts<T, true>
+		{
+		public:
+			target_counts() noexcept = default;
+			target_counts(const target_counts& other);
+			target_counts(target_counts&& other) noexcept;
+			target_counts& operator=(const target_counts& other);
+			target_counts& operator=(target_counts&& other) noexcept;
+			~target_counts();
+
+			void add(T* ptr, std::size_t count = 1u);
+			void remove(T* ptr) noexcept;
+			void clear() noexcept;
+			void swap(target_counts& other) noexcept;
+			std::size_t distinct_targets() const noexcept;
+		private:
+			std::unordered_map<T*, std::size_t> m_counts;
+		};
+
+		// --- release variant, does not count anything
+		template <typename T>
+		class target_counts<T, false>
+		{
+		public:
+			void add(T*, std::size_t = 1u) noexcept {}
+			void remove(T*) noexcept {}
+			void clear() noexcept {}
+			void swap(target_counts&) noexcept {}
+		};
+		#pragma endregion
+
+		#pragma region dependency_ptr_array_impl
+		// vector of dependency pointers. elements are read as T*, modifications go through the member functions.
+		template <typename T, bool counted>
+		class dependency_ptr_array_impl : private target_counts<T, counted>
+		{
+			using counts_t = target_counts<T, counted>;
+		public:
+			using value_type = T*;
+			using size_type = std::size_t;
+			using difference_type = std::ptrdiff_t;
+			using const_reference = T* const&;
+			using const_pointer = T* const*;
+			using const_iterator = typename std::vector<T*>::const_iterator;
+			using iterator = const_iterator;
+
+			dependency_ptr_array_impl() noexcept = default;
+			dependency_ptr_array_impl(size_type count, T* ptr);
+			dependency_ptr_array_impl(std::initializer_list<T*> ptrs);
+			template <typename iterator_t>
+			dependency_ptr_array_impl(iterator_t first, iterator_t last);
+			dependency_ptr_array_impl(const dependency_ptr_array_impl& other) = default;
+			dependency_ptr_array_impl(dependency_ptr_array_impl&& other) noexcept;
+			dependency_ptr_array_impl& operator=(const dependency_ptr_array_impl& other);
+			dependency_ptr_array_impl& operator=(dependency_ptr_array_impl&& other) noexcept;
+			~dependency_ptr_array_impl() = default;
+
+			// replaces the contents with [first, last) (T*, dependency_ptr<T>, ...)
+			template <typename iterator_t>
+			void assign(iterator_t first, iterator_t last);
+			void assign(size_type count, T* ptr);
+			// appends [first, last)
+			template <typename iterator_t>
+			void append(iterator_t first, iterator_t last);
+
+			void push_back(T* ptr);
+			void pop_back() noexcept;
+			void set(size_type pos, T* ptr);
+			const_iterator erase(const_iterator pos) noexcept;
+			const_iterator erase(const_iterator first, const_iterator last) noexcept;
+			void resize(size_type count, T* ptr = nullptr);
+			void clear() noexcept;
+			void reserve(size_type capacity);
+			void swap(dependency_ptr_array_impl& other) noexcept;
+
+			T* operator[](size_type pos) const noexcept;
+			T* at(size_type pos) const;
+			T* front() const noexcept;
+			T* back() const noexcept;
+			const_pointer data() const noexcept;
+
+			const_iterator begin() const noexcept;
+			const_iterator end() const noexcept;
+			const_iterator cbegin() const noexcept;
+			const_iterator cend() const noexcept;
+
+			size_type size() const noexcept;
+			size_type capacity() const noexcept;
+			bool empty() const noexcept;
+		private:
+			std::vector<T*> m_ptrs;
+		};
+
+		template <typename T, bool counted>
+		void swap(dependency_ptr_array_impl<T, counted>& lhs, dependency_ptr_array_impl<T, counted>& rhs) noexcept;
+		#pragma endregion
+	}
+
+	// Container of dependency pointers to T which holds one reference per distinct target instead of one per element.
+	// Copying, assigning, clearing or destroying it costs one counter update per distinct target. std::vector<T*> in release builds.
+	template <typename T>
+	using dependency_ptr_array = detail::dependency_ptr_array_impl<T, dependency_check_mode_v<T> != check_mode::off>;
+}
+
+#pragma region implementation
+// --- target_counts
+template <typename T>
+inline dptr::detail::target_counts<T, true>::target_counts(const target_counts& other) :
+	m_counts(other.m_counts)
+{
+	for(const auto& count : m_counts)
+		intrusive_ptr_add_ref(count.first);
+}
+template <typename T>
+inline dptr::detail::target_counts<T, true>::target_counts(target_counts&& other) noexcept :
+	m_counts(std::move(other.m_counts))
+{
+	other.m_counts.clear();
+}
+template <typename T>
+inline dptr::detail::target_counts<T, true>& dptr::detail::target_counts<T, true>::operator=(const target_counts& other)
+{
+	target_counts(other).swap(*this);
+	return *this;
+}
+template <typename T>
+inline dptr::detail::target_counts<T, true>& dptr::detail::target_counts<T, true>::operator=(target_counts&& other) noexcept
+{
+	target_counts(std::move(other)).swap(*this);
+	return *this;
+}
+template <typename T>
+inline dptr::detail::target_counts<T, true>::~target_counts()
+{
+	// checked here instead of in the class, where T may still be incomplete
+	static_assert(is_checked_dependency_v<T>, "[dptr::detail::target_counts]: dependency_ptr_array can only be used with types deriving guarded_dependency or arena_dependency or side table dependencies.");
+
+	clear();
+}
+template <typename T>
+inline void dptr::detail::target_counts<T, true>::add(T* ptr, std::size_t count)
+{
+	if(!ptr || !count) return;
+	auto& stored = m_counts[ptr];
+	if(stored == 0u)
+		intrusive_ptr_add_ref(ptr);
+	stored += count;
+}
+template <typename T>
+inline void dptr::detail::target_counts<T, true>::remove(T* ptr) noexcept
+{
+	if(!ptr) return;
+	const auto it = m_counts.find(ptr);
+	DPTR_ASSERT(it != m_counts.end(), "[dptr::detail::target_counts::remove]: The removed pointer was not counted.");
+	if(--it->second == 0u)
+	{
+		m_counts.erase(it);
+		intrusive_ptr_release(ptr);
+	}
+}
+template <typename T>
+inline void dptr::detail::target_counts<T, true>::clear() noexcept
+{
+	for(const auto& count : m_counts)
+		intrusive_ptr_release(count.first);
+	m_counts.clear();
+}
+template <typename T>
+inline void dptr::detail::target_counts<T, true>::swap(target_counts& other) noexcept
+{
+	m_counts.swap(other.m_counts);
+}
+template <typename T>
+inline std::size_t dptr::detail::target_counts<T, true>::distinct_targets() const noexcept
+{
+	return m_counts.size();
+}
+
+// --- dependency_ptr_array_impl
+template <typename T, bool counted>
+inline dptr::detail::dependency_ptr_array_impl<T, counted>::dependency_ptr_array_impl(size_type count, T* ptr)
+{
+	assign(count, ptr);
+}
+template <typename T, bool counted>
+inline dptr::detail::dependency_ptr_array_impl<T, counted>::dependency_ptr_array_impl(std::initializer_list<T*> ptrs)
+{
+	assign(ptrs.begin(), ptrs.end());
+}
+template <typename T, bool counted>
+template <typename iterator_t>
+inline dptr::detail::dependency_ptr_array_impl<T, counted>::dependency_ptr_array_impl(iterator_t first, iterator_t last)
+{
+	assign(first, last);
+}
+template <typename T, bool counted>
+inline dptr::detail::dependency_ptr_array_impl<T, counted>::dependency_ptr_array_impl(dependency_ptr_array_impl&& other) noexcept :
+	counts_t(std::move(static_cast<counts_t&>(other))),
+	m_ptrs(std::move(other.m_ptrs))
+{
+	other.m_ptrs.clear();
+}
+template <typename T, bool counted>
+inline dptr::detail::dependency_ptr_array_impl<T, counted>& dptr::detail::dependency_ptr_array_impl<T, counted>::operator=(const dependency_ptr_array_impl& other)
+{
+	dependency_ptr_array_impl(other).swap(*this);
+	return *this;
+}
+template <typename T, bool counted>
+inline dptr::detail::dependency_ptr_array_impl<T, counted>& dptr::detail::dependency_ptr_array_impl<T, counted>::operator=(dependency_ptr_array_impl&& other) noexcept
+{
+	dependency_ptr_array_impl(std::move(other)).swap(*this);
+	return *this;
+}
+template <typename T, bool counted>
+template <typename iterator_t>
+inline void dptr::detail::dependency_ptr_array_impl<T, counted>::assign(iterator_t first, iterator_t last)
+{
+	dependency_ptr_array_impl tmp;
+	tmp.append(first, last);
+	tmp.swap(*this);
+}
+template <typename T, bool counted>
+inline void dptr::detail::dependency_ptr_array_impl<T, counted>::assign(size_type count, T* ptr)
+{
+	dependency_ptr_array_impl tmp;
+	tmp.m_ptrs.assign(count, ptr);
+	tmp.counts_t::add(ptr, count);
+	tmp.swap(*this);
+}
+template <typename T, bool counted>
+template <typename iterator_t>
+inline void dptr::detail::dependency_ptr_array_impl<T, counted>::append(iterator_t first, iterator_t last)
+{
+	using category_t = typename std::iterator_traits<iterator_t>::iterator_category;
+	if constexpr(std::is_base_of_v<std::forward_iterator_tag, category_t>)
+		m_ptrs.reserve(m_ptrs.size() + static_cast<size_type>(std::distance(first, last)));
+	for(; first != last; ++first)
+	{
+		// implicit conversion: T*, dependency_ptr<U>, dependency_ref<U>, ...
+		T* const ptr = *first;
+		push_back(ptr);
+	}
+}
+template <typename T, bool counted>
+inline void dptr::detail::dependency_ptr_array_impl<T, counted>::push_back(T* ptr)
+{
+	m_ptrs.push_back(ptr);
+	try
+	{
+		counts_t::add(ptr);
+	}
+	catch(...)
+	{
+		m_ptrs.pop_back();
+		throw;
+	}
+}
+template <typename T, bool counted>
+inline void dptr::detail::dependency_ptr_array_impl<T, counted>::pop_back() noexcept
+{
+	DPTR_PRECONDITION(counted, !m_ptrs.empty(), "[dptr::detail::dependency_ptr_array_impl::pop_back]: The array is empty.");
+	counts_t::remove(m_ptrs.back());
+	m_ptrs.pop_back();
+}
+template <typename T, bool counted>
+inline void dptr::detail::dependency_ptr_array_impl<T, counted>::set(size_type pos, T* ptr)
+{
+	DPTR_PRECONDITION(counted, pos < m_ptrs.size(), "[dptr::detail::dependency_ptr_array_impl::set]: Index out of range.");
+	counts_t::add(ptr);
+	counts_t::remove(m_ptrs[pos]);
+	m_ptrs[pos] = ptr;
+}
+template <typename T, bool counted>
+inline typename dptr::detail::dependency_ptr_array_impl<T, counted>::const_iterator dptr::detail::dependency_ptr_array_impl<T, counted>::erase(const_iterator pos) noexcept
+{
+	counts_t::remove(*pos);
+	return m_ptrs.erase(pos);
+}
+template <typename T, bool counted>
+inline typename dptr::detail::dependency_ptr_array_impl<T, counted>::const_iterator dptr::detail::dependency_ptr_array_impl<T, counted>::erase(const_iterator first, const_iterator last) noexcept
+{
+	for(auto it = first; it != last; ++it)
+		counts_t::remove(*it);
+	return m_ptrs.erase(first, last);
+}
+template <typename T, bool counted>
+inline void dptr::detail::dependency_ptr_array_impl<T, counted>::resize(size_type count, T* ptr)
+{
+	if(count < m_ptrs.size())
+		erase(m_ptrs.begin() + static_cast<difference_type>(count), m_ptrs.end());
+	else
+	{
+		m_ptrs.reserve(count);
+		while(m_ptrs.size() < count)
+			push_back(ptr);
+	}
+}
+template <typename T, bool counted>
+inline void dptr::detail::dependency_ptr_array_impl<T, counted>::clear() noexcept
+{
+	counts_t::clear();
+	m_ptrs.clear();
+}
+template <typename T, bool counted>
+inline void dptr::detail::dependency_ptr_array_impl<T, counted>::reserve(size_type capacity)
+{
+	m_ptrs.reserve(capacity);
+}
+template <typename T, bool counted>
+inline void dptr::detail::dependency_ptr_array_impl<T, counted>::swap(dependency_ptr_array_impl& other) noexcept
+{
+	counts_t::swap(other);
+	m_ptrs.swap(other.m_ptrs);
+}
+template <typename T, bool counted>
+inline T* dptr::detail::dependency_ptr_array_impl<T, counted>::operator[](size_type pos) const noexcept
+{
+	DPTR_PRECONDITION(counted, pos < m_ptrs.size(), "[dptr::detail::dependency_ptr_array_impl::operator[]]: Index out of range.");
+	return m_ptrs[pos];
+}
+template <typename T, bool counted>
+inline T* dptr::detail::dependency_ptr_array_impl<T, counted>::at(size_type pos) const
+{
+	return m_ptrs.at(pos);
+}
+template <typename T, bool counted>
+inline T* dptr::detail::dependency_ptr_array_impl<T, counted>::front() const noexcept
+{
+	return m_ptrs.front();
+}
+template <typename T, bool counted>
+inline T* dptr::detail::dependency_ptr_array_impl<T, counted>::back() const noexcept
+{
+	return m_ptrs.back();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::dependency_ptr_array_impl<T, counted>::const_pointer dptr::detail::dependency_ptr_array_impl<T, counted>::data() const noexcept
+{
+	return m_ptrs.data();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::dependency_ptr_array_impl<T, counted>::const_iterator dptr::detail::dependency_ptr_array_impl<T, counted>::begin() const noexcept
+{
+	return m_ptrs.cbegin();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::dependency_ptr_array_impl<T, counted>::const_iterator dptr::detail::dependency_ptr_array_impl<T, counted>::end() const noexcept
+{
+	return m_ptrs.cend();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::dependency_ptr_array_impl<T, counted>::const_iterator dptr::detail::dependency_ptr_array_impl<T, counted>::cbegin() const noexcept
+{
+	return m_ptrs.cbegin();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::dependency_ptr_array_impl<T, counted>::const_iterator dptr::detail::dependency_ptr_array_impl<T, counted>::cend() const noexcept
+{
+	return m_ptrs.cend();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::dependency_ptr_array_impl<T, counted>::size_type dptr::detail::dependency_ptr_array_impl<T, counted>::size() const noexcept
+{
+	return m_ptrs.size();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::dependency_ptr_array_impl<T, counted>::size_type dptr::detail::dependency_ptr_array_impl<T, counted>::capacity() const noexcept
+{
+	return m_ptrs.capacity();
+}
+template <typename T, bool counted>
+inline bool dptr::detail::dependency_ptr_array_impl<T, counted>::empty() const noexcept
+{
+	return m_ptrs.empty();
+}
+template <typename T, bool counted>
+inline void dptr::detail::swap(dependency_ptr_array_impl<T, counted>& lhs, dependency_ptr_array_impl<T, counted>& rhs) noexcept
+{
+	lhs.swap(rhs);
+}
+#pragma endregion
+#endif
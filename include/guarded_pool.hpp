@@ -0,0 +1,558 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_GUARDED_POOL_H_
+#define _DPTR_GUARDED_POOL_H_
+
+#include "dependency_ptr.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace dptr
+{
+	// occupancy of a guarded_pool
+	struct pool_stats
+	{
+		std::size_t size;
+		std::size_t capacity;
+		std::size_t chunks;
+		// runs of consecutive erased slots, each is skipped with a single jump when iterating
+		std::size_t free_blocks;
+		// elements referenced by at least one dependency_ptr and the sum of their reference counts (0 in release builds)
+		std::size_t referenced;
+		std::size_t references;
+	};
+
+	// Object pool with stable addresses. Elements are stored in chunks of chunk_size slots which are never moved, so T does not
+	// need to allow move_from while referenced and dependency_ptrs to elements stay valid until the element is erased.
+	// Insertion and erasure by iterator are O(1): erased slots form runs which are kept in a free list and reused (most recently erased first).
+	// Iteration skips every run of erased slots with one jump (jump-counting skip field, 2 bytes per slot, and an occupancy bit per slot).
+	// Erasing a referenced element is reported in checked builds. Guarded dependencies which forbid destroy report it themselves,
+	// otherwise (e.g. side table dependencies or guarded_dependency<atomic, dependency_op_flags{0u}>) the pool checks the reference count.
+	// The pool itself can be moved freely, copies are not supported. Not thread-safe.
+	template <typename T, std::size_t chunk_size = 256u>
+	class guarded_pool
+	{
+		static_assert(chunk_size > 1u && chunk_size <= std::numeric_limits<std::uint16_t>::max(), "[dptr::guarded_pool]: chunk_size has to be in [2, 65535].");
+		struct chunk;
+	public:
+		using value_type = T;
+		using size_type = std::size_t;
+		using difference_type = std::ptrdiff_t;
+		using reference = T&;
+		using const_reference = const T&;
+		using pointer = T*;
+		using const_pointer = const T*;
+
+		template <bool is_const>
+		class iterator_base
+		{
+			friend class guarded_pool;
+			template <bool> friend class iterator_base;
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using value_type = T;
+			using difference_type = std::ptrdiff_t;
+			using pointer = std::conditional_t<is_const, const T*, T*>;
+			using reference = std::conditional_t<is_const, const T&, T&>;
+
+			iterator_base() noexcept = default;
+			// iterator -> const_iterator
+			template <bool other_const, typename = std::enable_if_t<is_const && !other_const>>
+			iterator_base(const iterator_base<other_const>& other) noexcept;
+
+			reference operator*() const noexcept;
+			pointer operator->() const noexcept;
+			iterator_base& operator++() noexcept;
+			iterator_base operator++(int) noexcept;
+			bool operator==(const iterator_base& rhs) const noexcept;
+			bool operator!=(const iterator_base& rhs) const noexcept;
+		private:
+			using chunks_t = std::conditional_t<is_const, const std::vector<std::unique_ptr<chunk>>, std::vector<std::unique_ptr<chunk>>>;
+			iterator_base(chunks_t* chunks, std::size_t chunk_index, std::size_t slot) noexcept;
+			// moves to the first element at or after the current slot
+			void skip() noexcept;
+
+			chunks_t* m_chunks = nullptr;
+			std::size_t m_chunk = 0u;
+			std::size_t m_slot = 0u;
+		};
+		using iterator = iterator_base<false>;
+		using const_iterator = iterator_base<true>;
+
+		guarded_pool() noexcept = default;
+		guarded_pool(const guarded_pool&) = delete;
+		// elements stay where they are
+		guarded_pool(guarded_pool&& other) noexcept;
+		guarded_pool& operator=(const guarded_pool&) = delete;
+		guarded_pool& operator=(guarded_pool&& other) noexcept;
+		~guarded_pool();
+
+		template <typename... args_t>
+		T& emplace(args_t&&... args);
+		T& insert(const T& value);
+		T& insert(T&& value);
+		// returns the iterator following pos
+		iterator erase(const_iterator pos) noexcept;
+		// O(log chunks), element has to be an element of this pool
+		void erase(const T* element) noexcept;
+		void clear() noexcept;
+		// allocates chunks until capacity() >= capacity
+		void reserve(size_type capacity);
+
+		// O(log chunks), nullptr if element is not an element of this pool
+		iterator iterator_to(const T* element) noexcept;
+		const_iterator iterator_to(const T* element) const noexcept;
+		bool contains(const T* element) const noexcept;
+
+		iterator begin() noexcept;
+		iterator end() noexcept;
+		const_iterator begin() const noexcept;
+		const_iterator end() const noexcept;
+		const_iterator cbegin() const noexcept;
+		const_iterator cend() const noexcept;
+
+		size_type size() const noexcept;
+		size_type capacity() const noexcept;
+		bool empty() const noexcept;
+		// O(1), except for referenced and references, which visit all elements in checked builds
+		pool_stats stats() const noexcept;
+	private:
+		static constexpr std::uint32_t no_block = std::numeric_limits<std::uint32_t>::max();
+
+		struct chunk
+		{
+			chunk() noexcept;
+			T* element(std::size_t slot) noexcept;
+			const T* element(std::size_t slot) const noexcept;
+			bool occupied(std::size_t slot) const noexcept;
+			void set_occupied(std::size_t slot, bool value) noexcept;
+
+			alignas(T) unsigned char storage[sizeof(T) * chunk_size];
+			// 0 for elements. first and last slot of a run of erased slots store its length, the slots in between are unused.
+			std::uint16_t skip[chunk_size];
+			// one bit per slot, set for elements. the skip field is only exact at the ends of a run.
+			std::uint64_t occupancy[(chunk_size + 63u) / 64u];
+			// free list of runs, linked by (chunk index * chunk_size + first slot). only valid for the first slot of a run.
+			std::uint32_t prev_block[chunk_size];
+			std::uint32_t next_block[chunk_size];
+		};
+
+		void add_chunk();
+		void link_block(std::uint32_t block) noexcept;
+		void unlink_block(std::uint32_t block) noexcept;
+		// releases the slot of a destroyed element, merging it with the neighbouring runs
+		void release_slot(std::size_t chunk_index, std::size_t slot) noexcept;
+		void destroy(T* element) noexcept;
+		// index of the chunk containing element or chunks.size()
+		std::size_t chunk_of(const T* element) const noexcept;
+
+		std::vector<std::unique_ptr<chunk>> m_chunks;
+		// chunk indices sorted by address for chunk_of
+		std::vector<std::uint32_t> m_chunk_order;
+		std::uint32_t m_free_head = no_block;
+		std::size_t m_free_blocks = 0u;
+		std::size_t m_size = 0u;
+	};
+}
+
+#pragma region implementation
+// --- guarded_pool::iterator_base
+template <typename T, std::size_t chunk_size>
+template <bool is_const>
+template <bool other_const, typename>
+inline dptr::guarded_pool<T, chunk_size>::iterator_base<is_const>::iterator_base(const iterator_base<other_const>& other) noexcept :
+	m_chunks(other.m_chunks),
+	m_chunk(other.m_chunk),
+	m_slot(other.m_slot)
+{
+}
+template <typename T, std::size_t chunk_size>
+template <bool is_const>
+inline dptr::guarded_pool<T, chunk_size>::iterator_base<is_const>::iterator_base(chunks_t* chunks, std::size_t chunk_index, std::size_t slot) noexcept :
+	m_chunks(chunks),
+	m_chunk(chunk_index),
+	m_slot(slot)
+{
+}
+template <typename T, std::size_t chunk_size>
+template <bool is_const>
+inline typename dptr::guarded_pool<T, chunk_size>::template iterator_base<is_const>::reference dptr::guarded_pool<T, chunk_size>::iterator_base<is_const>::operator*() const noexcept
+{
+	return *(*m_chunks)[m_chunk]->element(m_slot);
+}
+template <typename T, std::size_t chunk_size>
+template <bool is_const>
+inline typename dptr::guarded_pool<T, chunk_size>::template iterator_base<is_const>::pointer dptr::guarded_pool<T, chunk_size>::iterator_base<is_const>::operator->() const noexcept
+{
+	return (*m_chunks)[m_chunk]->element(m_slot);
+}
+template <typename T, std::size_t chunk_size>
+template <bool is_const>
+inline typename dptr::guarded_pool<T, chunk_size>::template iterator_base<is_const>& dptr::guarded_pool<T, chunk_size>::iterator_base<is_const>::operator++() noexcept
+{
+	++m_slot;
+	skip();
+	return *this;
+}
+template <typename T, std::size_t chunk_size>
+template <bool is_const>
+inline typename dptr::guarded_pool<T, chunk_size>::template iterator_base<is_const> dptr::guarded_pool<T, chunk_size>::iterator_base<is_const>::operator++(int) noexcept
+{
+	iterator_base it = *this;
+	++*this;
+	return it;
+}
+template <typename T, std::size_t chunk_size>
+template <bool is_const>
+inline bool dptr::guarded_pool<T, chunk_size>::iterator_base<is_const>::operator==(const iterator_base& rhs) const noexcept
+{
+	return m_chunk == rhs.m_chunk && m_slot == rhs.m_slot;
+}
+template <typename T, std::size_t chunk_size>
+template <bool is_const>
+inline bool dptr::guarded_pool<T, chunk_size>::iterator_base<is_const>::operator!=(const iterator_base& rhs) const noexcept
+{
+	return !(*this == rhs);
+}
+template <typename T, std::size_t chunk_size>
+template <bool is_const>
+inline void dptr::guarded_pool<T, chunk_size>::iterator_base<is_const>::skip() noexcept
+{
+	// the slot is either an element or the first slot of a run, after a run follows an element or the end of the chunk
+	while(m_chunk < m_chunks->size())
+	{
+		if(m_slot < chunk_size)
+		{
+			m_slot += (*m_chunks)[m_chunk]->skip[m_slot];
+			if(m_slot < chunk_size) return;
+		}
+		++m_chunk;
+		m_slot = 0u;
+	}
+}
+
+// --- guarded_pool::chunk
+template <typename T, std::size_t chunk_size>
+inline dptr::guarded_pool<T, chunk_size>::chunk::chunk() noexcept
+{
+	// one run of chunk_size erased slots
+	skip[0] = skip[chunk_size - 1u] = static_cast<std::uint16_t>(chunk_size);
+	std::fill(std::begin(occupancy), std::end(occupancy), std::uint64_t{0u});
+}
+template <typename T, std::size_t chunk_size>
+inline T* dptr::guarded_pool<T, chunk_size>::chunk::element(std::size_t slot) noexcept
+{
+	return std::launder(reinterpret_cast<T*>(storage + slot * sizeof(T)));
+}
+template <typename T, std::size_t chunk_size>
+inline const T* dptr::guarded_pool<T, chunk_size>::chunk::element(std::size_t slot) const noexcept
+{
+	return std::launder(reinterpret_cast<const T*>(storage + slot * sizeof(T)));
+}
+template <typename T, std::size_t chunk_size>
+inline bool dptr::guarded_pool<T, chunk_size>::chunk::occupied(std::size_t slot) const noexcept
+{
+	return (occupancy[slot / 64u] >> (slot % 64u)) & 1u;
+}
+template <typename T, std::size_t chunk_size>
+inline void dptr::guarded_pool<T, chunk_size>::chunk::set_occupied(std::size_t slot, bool value) noexcept
+{
+	const std::uint64_t bit = std::uint64_t{1u} << (slot % 64u);
+	occupancy[slot / 64u] = value ? occupancy[slot / 64u] | bit : occupancy[slot / 64u] & ~bit;
+}
+
+// --- guarded_pool
+template <typename T, std::size_t chunk_size>
+inline dptr::guarded_pool<T, chunk_size>::guarded_pool(guarded_pool&& other) noexcept :
+	m_chunks(std::move(other.m_chunks)),
+	m_chunk_order(std::move(other.m_chunk_order)),
+	m_free_head(std::exchange(other.m_free_head, no_block)),
+	m_free_blocks(std::exchange(other.m_free_blocks, 0u)),
+	m_size(std::exchange(other.m_size, 0u))
+{
+	other.m_chunks.clear();
+	other.m_chunk_order.clear();
+}
+template <typename T, std::size_t chunk_size>
+inline dptr::guarded_pool<T, chunk_size>& dptr::guarded_pool<T, chunk_size>::operator=(guarded_pool&& other) noexcept
+{
+	if(&other != this)
+	{
+		clear();
+		m_chunks = std::move(other.m_chunks);
+		m_chunk_order = std::move(other.m_chunk_order);
+		m_free_head = std::exchange(other.m_free_head, no_block);
+		m_free_blocks = std::exchange(other.m_free_blocks, 0u);
+		m_size = std::exchange(other.m_size, 0u);
+		other.m_chunks.clear();
+		other.m_chunk_order.clear();
+	}
+	return *this;
+}
+template <typename T, std::size_t chunk_size>
+inline dptr::guarded_pool<T, chunk_size>::~guarded_pool()
+{
+	clear();
+}
+template <typename T, std::size_t chunk_size>
+template <typename... args_t>
+inline T& dptr::guarded_pool<T, chunk_size>::emplace(args_t&&... args)
+{
+	if(m_free_head == no_block) add_chunk();
+	// the element is constructed in the first slot of the most recently freed run. nothing changes if the constructor throws.
+	const std::uint32_t block = m_free_head;
+	chunk& c = *m_chunks[block / chunk_size];
+	const std::size_t slot = block % chunk_size;
+	T* const element = ::new(static_cast<void*>(c.storage + slot * sizeof(T))) T(std::forward<args_t>(args)...);
+
+	const std::size_t length = c.skip[slot];
+	unlink_block(block);
+	c.skip[slot] = 0u;
+	c.set_occupied(slot, true);
+	if(length > 1u)
+	{
+		// the rest of the run
+		c.skip[slot + 1u] = c.skip[slot + length - 1u] = static_cast<std::uint16_t>(length - 1u);
+		link_block(block + 1u);
+	}
+	++m_size;
+	return *std::launder(element);
+}
+template <typename T, std::size_t chunk_size>
+inline T& dptr::guarded_pool<T, chunk_size>::insert(const T& value)
+{
+	return emplace(value);
+}
+template <typename T, std::size_t chunk_size>
+inline T& dptr::guarded_pool<T, chunk_size>::insert(T&& value)
+{
+	return emplace(std::move(value));
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::iterator dptr::guarded_pool<T, chunk_size>::erase(const_iterator pos) noexcept
+{
+	DPTR_ASSERT(pos.m_chunks == &m_chunks && pos.m_chunk < m_chunks.size() && m_chunks[pos.m_chunk]->occupied(pos.m_slot), "[dptr::guarded_pool::erase]: Invalid iterator.");
+	destroy(m_chunks[pos.m_chunk]->element(pos.m_slot));
+	release_slot(pos.m_chunk, pos.m_slot);
+	iterator next(&m_chunks, pos.m_chunk, pos.m_slot);
+	next.skip();
+	return next;
+}
+template <typename T, std::size_t chunk_size>
+inline void dptr::guarded_pool<T, chunk_size>::erase(const T* element) noexcept
+{
+	const const_iterator pos = iterator_to(element);
+	DPTR_ASSERT(pos != end(), "[dptr::guarded_pool::erase]: The object is not an element of this pool.");
+	erase(pos);
+}
+template <typename T, std::size_t chunk_size>
+inline void dptr::guarded_pool<T, chunk_size>::clear() noexcept
+{
+	for(iterator it = begin(); it != end(); ++it)
+		destroy(&*it);
+	// every chunk becomes a single run again
+	m_free_head = no_block;
+	m_free_blocks = 0u;
+	for(std::size_t i = m_chunks.size(); i-- > 0u;)
+	{
+		chunk& c = *m_chunks[i];
+		c.skip[0] = c.skip[chunk_size - 1u] = static_cast<std::uint16_t>(chunk_size);
+		std::fill(std::begin(c.occupancy), std::end(c.occupancy), std::uint64_t{0u});
+		link_block(static_cast<std::uint32_t>(i * chunk_size));
+	}
+	m_size = 0u;
+}
+template <typename T, std::size_t chunk_size>
+inline void dptr::guarded_pool<T, chunk_size>::reserve(size_type capacity)
+{
+	while(this->capacity() < capacity)
+		add_chunk();
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::iterator dptr::guarded_pool<T, chunk_size>::iterator_to(const T* element) noexcept
+{
+	const std::size_t chunk_index = chunk_of(element);
+	if(chunk_index == m_chunks.size()) return end();
+	const std::size_t offset = static_cast<std::size_t>(reinterpret_cast<const unsigned char*>(element) - m_chunks[chunk_index]->storage);
+	const std::size_t slot = offset / sizeof(T);
+	if(offset % sizeof(T) != 0u || !m_chunks[chunk_index]->occupied(slot)) return end();
+	return iterator(&m_chunks, chunk_index, slot);
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::const_iterator dptr::guarded_pool<T, chunk_size>::iterator_to(const T* element) const noexcept
+{
+	return const_cast<guarded_pool*>(this)->iterator_to(element);
+}
+template <typename T, std::size_t chunk_size>
+inline bool dptr::guarded_pool<T, chunk_size>::contains(const T* element) const noexcept
+{
+	return iterator_to(element) != end();
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::iterator dptr::guarded_pool<T, chunk_size>::begin() noexcept
+{
+	iterator it(&m_chunks, 0u, 0u);
+	it.skip();
+	return it;
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::iterator dptr::guarded_pool<T, chunk_size>::end() noexcept
+{
+	return iterator(&m_chunks, m_chunks.size(), 0u);
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::const_iterator dptr::guarded_pool<T, chunk_size>::begin() const noexcept
+{
+	const_iterator it(&m_chunks, 0u, 0u);
+	it.skip();
+	return it;
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::const_iterator dptr::guarded_pool<T, chunk_size>::end() const noexcept
+{
+	return const_iterator(&m_chunks, m_chunks.size(), 0u);
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::const_iterator dptr::guarded_pool<T, chunk_size>::cbegin() const noexcept
+{
+	return begin();
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::const_iterator dptr::guarded_pool<T, chunk_size>::cend() const noexcept
+{
+	return end();
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::size_type dptr::guarded_pool<T, chunk_size>::size() const noexcept
+{
+	return m_size;
+}
+template <typename T, std::size_t chunk_size>
+inline typename dptr::guarded_pool<T, chunk_size>::size_type dptr::guarded_pool<T, chunk_size>::capacity() const noexcept
+{
+	return m_chunks.size() * chunk_size;
+}
+template <typename T, std::size_t chunk_size>
+inline bool dptr::guarded_pool<T, chunk_size>::empty() const noexcept
+{
+	return m_size == 0u;
+}
+template <typename T, std::size_t chunk_size>
+inline dptr::pool_stats dptr::guarded_pool<T, chunk_size>::stats() const noexcept
+{
+	pool_stats stats{m_size, capacity(), m_chunks.size(), m_free_blocks, 0u, 0u};
+	if constexpr(detail::is_checked_dependency_v<T>)
+	{
+		for(const T& element : *this)
+		{
+			const std::size_t count = detail::reference_count(&element);
+			stats.referenced += count != 0u;
+			stats.references += count;
+		}
+	}
+	return stats;
+}
+template <typename T, std::size_t chunk_size>
+inline void dptr::guarded_pool<T, chunk_size>::add_chunk()
+{
+	DPTR_ASSERT((m_chunks.size() + 1u) * chunk_size <= no_block, "[dptr::guarded_pool::add_chunk]: Too many chunks.");
+	m_chunks.reserve(m_chunks.size() + 1u);
+	m_chunk_order.reserve(m_chunks.size() + 1u);
+	m_chunks.push_back(std::make_unique<chunk>());
+	const std::uint32_t chunk_index = static_cast<std::uint32_t>(m_chunks.size() - 1u);
+	const void* const storage = m_chunks.back()->storage;
+	const std::less<const void*> less;
+	m_chunk_order.insert(std::upper_bound(m_chunk_order.begin(), m_chunk_order.end(), storage, [this, &less](const void* lhs, std::uint32_t rhs) { return less(lhs, m_chunks[rhs]->storage); }), chunk_index);
+	link_block(static_cast<std::uint32_t>(chunk_index * chunk_size));
+}
+template <typename T, std::size_t chunk_size>
+inline void dptr::guarded_pool<T, chunk_size>::link_block(std::uint32_t block) noexcept
+{
+	chunk& c = *m_chunks[block / chunk_size];
+	const std::size_t slot = block % chunk_size;
+	c.prev_block[slot] = no_block;
+	c.next_block[slot] = m_free_head;
+	if(m_free_head != no_block) m_chunks[m_free_head / chunk_size]->prev_block[m_free_head % chunk_size] = block;
+	m_free_head = block;
+	++m_free_blocks;
+}
+template <typename T, std::size_t chunk_size>
+inline void dptr::guarded_pool<T, chunk_size>::unlink_block(std::uint32_t block) noexcept
+{
+	const chunk& c = *m_chunks[block / chunk_size];
+	const std::uint32_t prev = c.prev_block[block % chunk_size];
+	const std::uint32_t next = c.next_block[block % chunk_size];
+	if(prev != no_block) m_chunks[prev / chunk_size]->next_block[prev % chunk_size] = next;
+	else m_free_head = next;
+	if(next != no_block) m_chunks[next / chunk_size]->prev_block[next % chunk_size] = prev;
+	--m_free_blocks;
+}
+template <typename T, std::size_t chunk_size>
+inline void dptr::guarded_pool<T, chunk_size>::release_slot(std::size_t chunk_index, std::size_t slot) noexcept
+{
+	chunk& c = *m_chunks[chunk_index];
+	const std::uint32_t block = static_cast<std::uint32_t>(chunk_index * chunk_size + slot);
+	// last slot of the run before and first slot of the run after the released slot, if any
+	const std::size_t left = slot > 0u ? c.skip[slot - 1u] : 0u;
+	const std::size_t right = slot + 1u < chunk_size ? c.skip[slot + 1u] : 0u;
+	if(right != 0u) unlink_block(block + 1u);
+	// the run before keeps its first slot (and its free list entry)
+	if(left == 0u) link_block(block);
+	const std::uint16_t length = static_cast<std::uint16_t>(left + 1u + right);
+	c.skip[slot - left] = c.skip[slot + right] = length;
+	c.set_occupied(slot, false);
+	--m_size;
+}
+template <typename T, std::size_t chunk_size>
+inline void dptr::guarded_pool<T, chunk_size>::destroy(T* element) noexcept
+{
+	// the pool checks erasures unless the element does so itself
+	if constexpr(detail::needs_destroy_check<T>::value)
+		DPTR_ASSERT_UNREFERENCED(dependency_op::destroy, detail::reference_count(element), detail::dependency_address(element), "[dptr::guarded_pool::erase]: There were still (now dangling!) pointers referencing the erased element.");
+	element->~T();
+}
+template <typename T, std::size_t chunk_size>
+inline std::size_t dptr::guarded_pool<T, chunk_size>::chunk_of(const T* element) const noexcept
+{
+	const std::less<const void*> less;
+	// last chunk starting at or before element
+	auto it = std::upper_bound(m_chunk_order.begin(), m_chunk_order.end(), static_cast<const void*>(element), [this, &less](const void* lhs, std::uint32_t rhs) { return less(lhs, m_chunks[rhs]->storage); });
+	if(it == m_chunk_order.begin()) return m_chunks.size();
+	--it;
+	const unsigned char* const storage = m_chunks[*it]->storage;
+	return less(static_cast<const void*>(element), storage + sizeof(T) * chunk_size) ? *it : m_chunks.size();
+}
+#pragma endregion
+#endif
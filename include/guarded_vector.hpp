@@ -0,0 +1,594 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_GUARDED_VECTOR_H_
+#define _DPTR_GUARDED_VECTOR_H_
+
+#include "dependency_ptr.hpp"
+
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+namespace dptr
+{
+	// Counter policy of the elements of a guarded_vector. Counts the references to the element (using counter_policy) and additionally
+	// the references to all elements of the container the element was constructed in, so relocations are checked once per container.
+	// Elements constructed outside of a guarded_vector only count their own references.
+	template <typename counter_policy = default_counter<false>>
+	class element_counter
+	{
+	public:
+		static constexpr bool is_atomic = counter_policy::is_atomic;
+		// does not depend on the element type, which may still be incomplete when the container is declared
+		using aggregate_type = detail::borrow_counter;
+
+		// makes aggregate the container of the elements constructed on the calling thread while it lives
+		class binding
+		{
+		public:
+			explicit binding(aggregate_type* aggregate) noexcept;
+			binding(const binding&) = delete;
+			binding& operator=(const binding&) = delete;
+			~binding();
+		private:
+			aggregate_type* m_previous;
+		};
+
+		element_counter() noexcept;
+		element_counter(const element_counter&) = delete;
+		element_counter& operator=(const element_counter&) = delete;
+		void inc() noexcept;
+		void dec() noexcept;
+		std::size_t load() const noexcept;
+	private:
+		static aggregate_type*& current_aggregate() noexcept;
+		counter_policy m_counter;
+		aggregate_type* const m_aggregate;
+	};
+
+	// Base class of guarded_vector elements. Elements do not check forbidden operations themselves, the container checks
+	// all relocations, erasures and its destruction instead. Use assert_unreferenced for elements living outside of a guarded_vector.
+	template <bool atomic = false, typename counter_policy = default_counter<atomic>, check_mode mode = default_check_mode>
+	using guarded_element = guarded_dependency<atomic, dependency_op_flags{0u}, element_counter<counter_policy>, mode>;
+
+	namespace detail
+	{
+		// element_counter used by a guarded_element (possibly wrapped by sampled_counter), void for other counter policies
+		template <typename counter>
+		struct element_counter_of { using type = void; };
+		template <typename counter_policy>
+		struct element_counter_of<element_counter<counter_policy>> { using type = element_counter<counter_policy>; };
+		template <typename counter_policy>
+		struct element_counter_of<sampled_counter<element_counter<counter_policy>>> { using type = element_counter<counter_policy>; };
+
+		template <typename T, typename = void>
+		struct is_guarded_element : std::false_type {};
+		template <typename T>
+		struct is_guarded_element<T, std::enable_if_t<is_guarded_dependency<T>::value>> :
+			std::bool_constant<!std::is_void_v<typename element_counter_of<typename T::dep_ref_counter_type>::type>> {};
+
+		#pragma region element_counts
+		// Aggregate reference count of the elements of a guarded_vector. Allocated on first use, so that moving the container
+		// does not move the counter the elements point to.
+		template <typename T, bool counted>
+		class element_counts;
+
+		template <typename T>
+		class element_counts<T, true>
+		{
+		public:
+			element_counts() noexcept = default;
+			element_counts(const element_counts&) = delete;
+			element_counts(element_counts&& other) noexcept;
+			element_counts& operator=(const element_counts&) = delete;
+			element_counts& operator=(element_counts&& other) = delete;
+			~element_counts();
+
+			// elements constructed while the returned binding lives count against this container
+			auto bind();
+			// asserts that no element in [first, last) of elements is referenced. O(1) if no element of the container is referenced,
+			// otherwise every referenced element in the range is reported with its index (violation::index).
+			void check_unreferenced(const T* elements, std::size_t first, std::size_t last, dptr::dependency_op op, const char* message) const noexcept;
+			std::size_t references() const noexcept;
+			void swap(element_counts& other) noexcept;
+		private:
+			std::unique_ptr<borrow_counter> m_aggregate;
+		};
+
+		// --- release variant, does not count anything
+		template <typename T>
+		class element_counts<T, false>
+		{
+		public:
+			struct binding {};
+			binding bind() noexcept { return {}; }
+			void check_unreferenced(const T*, std::size_t, std::size_t, dptr::dependency_op, const char*) const noexcept {}
+			std::size_t references() const noexcept { return 0u; }
+			void swap(element_counts&) noexcept {}
+		};
+		#pragma endregion
+
+		#pragma region guarded_vector_impl
+		// std::vector of guarded elements. Operations which move or destroy elements check the affected range once
+		// instead of once per element.
+		template <typename T, bool counted>
+		class guarded_vector_impl : private element_counts<T, counted>
+		{
+			using counts_t = element_counts<T, counted>;
+		public:
+			using value_type = T;
+			using size_type = std::size_t;
+			using difference_type = std::ptrdiff_t;
+			using reference = T&;
+			using const_reference = const T&;
+			using pointer = T*;
+			using const_pointer = const T*;
+			using iterator = typename std::vector<T>::iterator;
+			using const_iterator = typename std::vector<T>::const_iterator;
+
+			guarded_vector_impl() noexcept = default;
+			explicit guarded_vector_impl(size_type count);
+			guarded_vector_impl(size_type count, const T& value);
+			guarded_vector_impl(std::initializer_list<T> values);
+			template <typename iterator_t>
+			guarded_vector_impl(iterator_t first, iterator_t last);
+			guarded_vector_impl(const guarded_vector_impl& other);
+			// elements stay where they are
+			guarded_vector_impl(guarded_vector_impl&& other) noexcept;
+			guarded_vector_impl& operator=(const guarded_vector_impl& other);
+			guarded_vector_impl& operator=(guarded_vector_impl&& other) noexcept;
+			~guarded_vector_impl();
+
+			void reserve(size_type capacity);
+			void shrink_to_fit();
+			void resize(size_type count);
+			void resize(size_type count, const T& value);
+			void push_back(const T& value);
+			void push_back(T&& value);
+			template <typename... args_t>
+			T& emplace_back(args_t&&... args);
+			void pop_back() noexcept;
+			iterator insert(const_iterator pos, const T& value);
+			iterator insert(const_iterator pos, T&& value);
+			template <typename... args_t>
+			iterator emplace(const_iterator pos, args_t&&... args);
+			iterator erase(const_iterator pos);
+			iterator erase(const_iterator first, const_iterator last);
+			void clear() noexcept;
+			void swap(guarded_vector_impl& other) noexcept;
+
+			T& operator[](size_type pos) noexcept;
+			const T& operator[](size_type pos) const noexcept;
+			T& at(size_type pos);
+			const T& at(size_type pos) const;
+			T& front() noexcept;
+			const T& front() const noexcept;
+			T& back() noexcept;
+			const T& back() const noexcept;
+			T* data() noexcept;
+			const T* data() const noexcept;
+
+			iterator begin() noexcept;
+			iterator end() noexcept;
+			const_iterator begin() const noexcept;
+			const_iterator end() const noexcept;
+			const_iterator cbegin() const noexcept;
+			const_iterator cend() const noexcept;
+
+			size_type size() const noexcept;
+			size_type capacity() const noexcept;
+			bool empty() const noexcept;
+			// dependency_ptrs referencing any element (0 in release builds)
+			std::size_t references() const noexcept;
+		private:
+			// checks all elements if growing to new_size reallocates. returns whether it did.
+			bool check_growth(size_type new_size) const noexcept;
+			// checks the elements from pos to the end, which are moved or destroyed
+			void check_tail(size_type pos, dptr::dependency_op op, const char* message) const noexcept;
+			std::vector<T> m_elements;
+		};
+
+		template <typename T, bool counted>
+		void swap(guarded_vector_impl<T, counted>& lhs, guarded_vector_impl<T, counted>& rhs) noexcept;
+		#pragma endregion
+	}
+
+	// Vector of elements deriving guarded_element. References to all elements are additionally counted per container, so reallocations,
+	// insertions, erasures and destruction are checked with a single load as long as no element is referenced. If an element
+	// is still referenced, the referenced elements of the affected range are reported. Plain std::vector<T> wrapper in release builds.
+	template <typename T>
+	using guarded_vector = detail::guarded_vector_impl<T, dependency_check_mode_v<T> != check_mode::off>;
+}
+
+#pragma region implementation
+// --- element_counter
+template <typename counter_policy>
+inline dptr::element_counter<counter_policy>::binding::binding(aggregate_type* aggregate) noexcept :
+	m_previous(current_aggregate())
+{
+	current_aggregate() = aggregate;
+}
+template <typename counter_policy>
+inline dptr::element_counter<counter_policy>::binding::~binding()
+{
+	current_aggregate() = m_previous;
+}
+template <typename counter_policy>
+inline dptr::element_counter<counter_policy>::element_counter() noexcept :
+	m_counter(),
+	m_aggregate(current_aggregate())
+{
+}
+template <typename counter_policy>
+inline void dptr::element_counter<counter_policy>::inc() noexcept
+{
+	m_counter.inc();
+	if(m_aggregate) m_aggregate->template inc<is_atomic>();
+}
+template <typename counter_policy>
+inline void dptr::element_counter<counter_policy>::dec() noexcept
+{
+	m_counter.dec();
+	if(m_aggregate) m_aggregate->template dec<is_atomic>();
+}
+template <typename counter_policy>
+inline std::size_t dptr::element_counter<counter_policy>::load() const noexcept
+{
+	return m_counter.load();
+}
+template <typename counter_policy>
+inline typename dptr::element_counter<counter_policy>::aggregate_type*& dptr::element_counter<counter_policy>::current_aggregate() noexcept
+{
+	thread_local aggregate_type* aggregate = nullptr;
+	return aggregate;
+}
+
+// --- element_counts
+template <typename T>
+inline dptr::detail::element_counts<T, true>::element_counts(element_counts&& other) noexcept :
+	m_aggregate(std::move(other.m_aggregate))
+{
+}
+template <typename T>
+inline dptr::detail::element_counts<T, true>::~element_counts()
+{
+	// checked here instead of in the class, where T may still be incomplete
+	static_assert(is_guarded_element<T>::value, "[dptr::detail::element_counts]: guarded_vector can only be used with types deriving guarded_element.");
+}
+template <typename T>
+inline auto dptr::detail::element_counts<T, true>::bind()
+{
+	using counter_t = typename element_counter_of<typename T::dep_ref_counter_type>::type;
+	if(!m_aggregate) m_aggregate = std::make_unique<borrow_counter>();
+	return typename counter_t::binding(m_aggregate.get());
+}
+template <typename T>
+inline void dptr::detail::element_counts<T, true>::check_unreferenced(const T* elements, std::size_t first, std::size_t last, dptr::dependency_op op, const char* message) const noexcept
+{
+	if(references() == 0u) return;
+	// references into other parts of the container are fine, every referenced element in [first, last) is reported
+	for(std::size_t i = first; i < last; ++i)
+		detail::check_unreferenced(static_cast<dptr::dependency_op_flags>(op), reference_count(elements + i), dependency_address(elements + i), "reference_count(elements + i) == 0", message, __FILE__, __LINE__, i);
+}
+template <typename T>
+inline std::size_t dptr::detail::element_counts<T, true>::references() const noexcept
+{
+	return m_aggregate ? m_aggregate->load() : 0u;
+}
+template <typename T>
+inline void dptr::detail::element_counts<T, true>::swap(element_counts& other) noexcept
+{
+	m_aggregate.swap(other.m_aggregate);
+}
+// --- guarded_vector_impl
+template <typename T, bool counted>
+inline dptr::detail::guarded_vector_impl<T, counted>::guarded_vector_impl(size_type count)
+{
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements.resize(count);
+}
+template <typename T, bool counted>
+inline dptr::detail::guarded_vector_impl<T, counted>::guarded_vector_impl(size_type count, const T& value)
+{
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements.assign(count, value);
+}
+template <typename T, bool counted>
+inline dptr::detail::guarded_vector_impl<T, counted>::guarded_vector_impl(std::initializer_list<T> values)
+{
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements.assign(values);
+}
+template <typename T, bool counted>
+template <typename iterator_t>
+inline dptr::detail::guarded_vector_impl<T, counted>::guarded_vector_impl(iterator_t first, iterator_t last)
+{
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements.assign(first, last);
+}
+template <typename T, bool counted>
+inline dptr::detail::guarded_vector_impl<T, counted>::guarded_vector_impl(const guarded_vector_impl& other) :
+	counts_t()
+{
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements = other.m_elements;
+}
+template <typename T, bool counted>
+inline dptr::detail::guarded_vector_impl<T, counted>::guarded_vector_impl(guarded_vector_impl&& other) noexcept :
+	counts_t(std::move(static_cast<counts_t&>(other))),
+	m_elements(std::move(other.m_elements))
+{
+	other.m_elements.clear();
+}
+template <typename T, bool counted>
+inline dptr::detail::guarded_vector_impl<T, counted>& dptr::detail::guarded_vector_impl<T, counted>::operator=(const guarded_vector_impl& other)
+{
+	// the old elements are checked when the temporary is destroyed
+	guarded_vector_impl(other).swap(*this);
+	return *this;
+}
+template <typename T, bool counted>
+inline dptr::detail::guarded_vector_impl<T, counted>& dptr::detail::guarded_vector_impl<T, counted>::operator=(guarded_vector_impl&& other) noexcept
+{
+	guarded_vector_impl(std::move(other)).swap(*this);
+	return *this;
+}
+template <typename T, bool counted>
+inline dptr::detail::guarded_vector_impl<T, counted>::~guarded_vector_impl()
+{
+	check_tail(0u, dependency_op::destroy, "[dptr::detail::guarded_vector_impl::~guarded_vector_impl]: There were still (now dangling!) pointers referencing elements of the destroyed vector.");
+}
+template <typename T, bool counted>
+inline void dptr::detail::guarded_vector_impl<T, counted>::reserve(size_type capacity)
+{
+	check_growth(capacity);
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements.reserve(capacity);
+}
+template <typename T, bool counted>
+inline void dptr::detail::guarded_vector_impl<T, counted>::shrink_to_fit()
+{
+	if(m_elements.size() == m_elements.capacity()) return;
+	check_tail(0u, dependency_op::move_from, "[dptr::detail::guarded_vector_impl::shrink_to_fit]: There were still (now invalid!) pointers referencing elements of the reallocated vector.");
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements.shrink_to_fit();
+}
+template <typename T, bool counted>
+inline void dptr::detail::guarded_vector_impl<T, counted>::resize(size_type count)
+{
+	if(count < m_elements.size())
+		check_tail(count, dependency_op::destroy, "[dptr::detail::guarded_vector_impl::resize]: There were still (now dangling!) pointers referencing removed elements.");
+	else
+		check_growth(count);
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements.resize(count);
+}
+template <typename T, bool counted>
+inline void dptr::detail::guarded_vector_impl<T, counted>::resize(size_type count, const T& value)
+{
+	if(count < m_elements.size())
+		check_tail(count, dependency_op::destroy, "[dptr::detail::guarded_vector_impl::resize]: There were still (now dangling!) pointers referencing removed elements.");
+	else
+		check_growth(count);
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements.resize(count, value);
+}
+template <typename T, bool counted>
+inline void dptr::detail::guarded_vector_impl<T, counted>::push_back(const T& value)
+{
+	check_growth(m_elements.size() + 1u);
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements.push_back(value);
+}
+template <typename T, bool counted>
+inline void dptr::detail::guarded_vector_impl<T, counted>::push_back(T&& value)
+{
+	check_growth(m_elements.size() + 1u);
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	m_elements.push_back(std::move(value));
+}
+template <typename T, bool counted>
+template <typename... args_t>
+inline T& dptr::detail::guarded_vector_impl<T, counted>::emplace_back(args_t&&... args)
+{
+	check_growth(m_elements.size() + 1u);
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	return m_elements.emplace_back(std::forward<args_t>(args)...);
+}
+template <typename T, bool counted>
+inline void dptr::detail::guarded_vector_impl<T, counted>::pop_back() noexcept
+{
+	DPTR_PRECONDITION(counted, !m_elements.empty(), "[dptr::detail::guarded_vector_impl::pop_back]: The vector is empty.");
+	check_tail(m_elements.size() - 1u, dependency_op::destroy, "[dptr::detail::guarded_vector_impl::pop_back]: There were still (now dangling!) pointers referencing the removed element.");
+	m_elements.pop_back();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::iterator dptr::detail::guarded_vector_impl<T, counted>::insert(const_iterator pos, const T& value)
+{
+	return emplace(pos, value);
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::iterator dptr::detail::guarded_vector_impl<T, counted>::insert(const_iterator pos, T&& value)
+{
+	return emplace(pos, std::move(value));
+}
+template <typename T, bool counted>
+template <typename... args_t>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::iterator dptr::detail::guarded_vector_impl<T, counted>::emplace(const_iterator pos, args_t&&... args)
+{
+	// a reallocation already checked every element
+	if(!check_growth(m_elements.size() + 1u))
+		check_tail(static_cast<size_type>(pos - m_elements.cbegin()), dependency_op::move_from, "[dptr::detail::guarded_vector_impl::emplace]: There were still (now invalid!) pointers referencing elements moved by the insertion.");
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	return m_elements.emplace(pos, std::forward<args_t>(args)...);
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::iterator dptr::detail::guarded_vector_impl<T, counted>::erase(const_iterator pos)
+{
+	return erase(pos, pos + 1);
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::iterator dptr::detail::guarded_vector_impl<T, counted>::erase(const_iterator first, const_iterator last)
+{
+	check_tail(static_cast<size_type>(first - m_elements.cbegin()), dependency_op::move_from, "[dptr::detail::guarded_vector_impl::erase]: There were still (now invalid!) pointers referencing erased or moved elements.");
+	[[maybe_unused]] const auto binding = counts_t::bind();
+	return m_elements.erase(first, last);
+}
+template <typename T, bool counted>
+inline void dptr::detail::guarded_vector_impl<T, counted>::clear() noexcept
+{
+	check_tail(0u, dependency_op::destroy, "[dptr::detail::guarded_vector_impl::clear]: There were still (now dangling!) pointers referencing elements of the cleared vector.");
+	m_elements.clear();
+}
+template <typename T, bool counted>
+inline void dptr::detail::guarded_vector_impl<T, counted>::swap(guarded_vector_impl& other) noexcept
+{
+	// elements stay where they are, their aggregate counter moves along with them
+	counts_t::swap(other);
+	m_elements.swap(other.m_elements);
+}
+template <typename T, bool counted>
+inline T& dptr::detail::guarded_vector_impl<T, counted>::operator[](size_type pos) noexcept
+{
+	DPTR_PRECONDITION(counted, pos < m_elements.size(), "[dptr::detail::guarded_vector_impl::operator[]]: Index out of range.");
+	return m_elements[pos];
+}
+template <typename T, bool counted>
+inline const T& dptr::detail::guarded_vector_impl<T, counted>::operator[](size_type pos) const noexcept
+{
+	DPTR_PRECONDITION(counted, pos < m_elements.size(), "[dptr::detail::guarded_vector_impl::operator[]]: Index out of range.");
+	return m_elements[pos];
+}
+template <typename T, bool counted>
+inline T& dptr::detail::guarded_vector_impl<T, counted>::at(size_type pos)
+{
+	return m_elements.at(pos);
+}
+template <typename T, bool counted>
+inline const T& dptr::detail::guarded_vector_impl<T, counted>::at(size_type pos) const
+{
+	return m_elements.at(pos);
+}
+template <typename T, bool counted>
+inline T& dptr::detail::guarded_vector_impl<T, counted>::front() noexcept
+{
+	return m_elements.front();
+}
+template <typename T, bool counted>
+inline const T& dptr::detail::guarded_vector_impl<T, counted>::front() const noexcept
+{
+	return m_elements.front();
+}
+template <typename T, bool counted>
+inline T& dptr::detail::guarded_vector_impl<T, counted>::back() noexcept
+{
+	return m_elements.back();
+}
+template <typename T, bool counted>
+inline const T& dptr::detail::guarded_vector_impl<T, counted>::back() const noexcept
+{
+	return m_elements.back();
+}
+template <typename T, bool counted>
+inline T* dptr::detail::guarded_vector_impl<T, counted>::data() noexcept
+{
+	return m_elements.data();
+}
+template <typename T, bool counted>
+inline const T* dptr::detail::guarded_vector_impl<T, counted>::data() const noexcept
+{
+	return m_elements.data();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::iterator dptr::detail::guarded_vector_impl<T, counted>::begin() noexcept
+{
+	return m_elements.begin();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::iterator dptr::detail::guarded_vector_impl<T, counted>::end() noexcept
+{
+	return m_elements.end();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::const_iterator dptr::detail::guarded_vector_impl<T, counted>::begin() const noexcept
+{
+	return m_elements.cbegin();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::const_iterator dptr::detail::guarded_vector_impl<T, counted>::end() const noexcept
+{
+	return m_elements.cend();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::const_iterator dptr::detail::guarded_vector_impl<T, counted>::cbegin() const noexcept
+{
+	return m_elements.cbegin();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::const_iterator dptr::detail::guarded_vector_impl<T, counted>::cend() const noexcept
+{
+	return m_elements.cend();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::size_type dptr::detail::guarded_vector_impl<T, counted>::size() const noexcept
+{
+	return m_elements.size();
+}
+template <typename T, bool counted>
+inline typename dptr::detail::guarded_vector_impl<T, counted>::size_type dptr::detail::guarded_vector_impl<T, counted>::capacity() const noexcept
+{
+	return m_elements.capacity();
+}
+template <typename T, bool counted>
+inline bool dptr::detail::guarded_vector_impl<T, counted>::empty() const noexcept
+{
+	return m_elements.empty();
+}
+template <typename T, bool counted>
+inline std::size_t dptr::detail::guarded_vector_impl<T, counted>::references() const noexcept
+{
+	return counts_t::references();
+}
+template <typename T, bool counted>
+inline bool dptr::detail::guarded_vector_impl<T, counted>::check_growth(size_type new_size) const noexcept
+{
+	if(new_size <= m_elements.capacity()) return false;
+	check_tail(0u, dependency_op::move_from, "[dptr::detail::guarded_vector_impl]: There were still (now invalid!) pointers referencing elements of the reallocated vector.");
+	return true;
+}
+template <typename T, bool counted>
+inline void dptr::detail::guarded_vector_impl<T, counted>::check_tail(size_type pos, dptr::dependency_op op, const char* message) const noexcept
+{
+	counts_t::check_unreferenced(m_elements.data(), pos, m_elements.size(), op, message);
+}
+template <typename T, bool counted>
+inline void dptr::detail::swap(guarded_vector_impl<T, counted>& lhs, guarded_vector_impl<T, counted>& rhs) noexcept
+{
+	lhs.swap(rhs);
+}
+#pragma endregion
+#endif
@@ -0,0 +1,269 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_LAZY_DEPENDENCY_PTR_H_
+#define _DPTR_LAZY_DEPENDENCY_PTR_H_
+
+#include "dependency_ptr.hpp"
+
+#include <functional>
+
+namespace dptr
+{
+	namespace detail
+	{
+		// reference held by a bound lazy_ptr. counted bindings hold a dependency_pointer_impl acquired at the site the lazy pointer was created.
+		template <typename T, bool counted>
+		class lazy_binding
+		{
+		public:
+			explicit lazy_binding(source_site site) noexcept;
+			lazy_binding(const lazy_binding& other);
+			lazy_binding(lazy_binding&& other) noexcept = default;
+			lazy_binding& operator=(const lazy_binding& other) = default;
+			lazy_binding& operator=(lazy_binding&& other) noexcept = default;
+
+			void bind(T* ptr);
+		private:
+			dependency_pointer_impl<T> m_dependency;
+			source_site m_site;
+		};
+
+		// --- release variant, does not count anything
+		template <typename T>
+		class lazy_binding<T, false>
+		{
+		public:
+			explicit lazy_binding(source_site) noexcept {}
+			void bind(T*) noexcept {}
+		};
+
+		// Pointer which calls its resolver on first access and keeps the result. Binding is thread-safe: concurrent first accesses
+		// wait for a single call of the resolver. Afterwards, an access is an acquire load and a test for nullptr.
+		// A resolver returning nullptr binds nothing, the next access calls it again.
+		template <typename T, bool counted>
+		class lazy_ptr
+		{
+		public:
+			using element_type = T;
+			using pointer = T*;
+			using resolver_type = std::function<T*()>;
+
+			lazy_ptr() noexcept;
+			lazy_ptr(std::nullptr_t) noexcept;
+			explicit lazy_ptr(resolver_type resolver, source_site site = source_site::current()) noexcept;
+			// copies the resolver and the binding (adding a reference if bound)
+			lazy_ptr(const lazy_ptr& other);
+			lazy_ptr(lazy_ptr&& other) noexcept;
+			lazy_ptr& operator=(const lazy_ptr& other);
+			lazy_ptr& operator=(lazy_ptr&& other) noexcept;
+			~lazy_ptr() = default;
+
+			// unbinds and replaces the resolver. not thread-safe.
+			void reset(resolver_type resolver = nullptr, source_site site = source_site::current());
+			bool bound() const noexcept;
+
+			// bind on first call, rethrow exceptions thrown by the resolver
+			T* get() const;
+			T& operator*() const;
+			T* operator->() const;
+			explicit operator bool() const;
+		private:
+			// calls the resolver unless another thread bound the pointer in the meantime
+			T* bind() const;
+			void lock() const noexcept;
+			void unlock() const noexcept;
+
+			mutable std::atomic<T*> m_ptr;
+			mutable std::atomic<bool> m_locked;
+			mutable lazy_binding<T, counted> m_binding;
+			resolver_type m_resolver;
+		};
+	}
+
+	// dependency_ptr which binds to the result of a resolver on first operator->, operator* or get(), e.g. to look services up in a registry
+	// only when they are used. In checked builds, the pointer references its target from the time it was bound.
+	// The resolver must not access the same pointer. Copying, assigning and resetting are not thread-safe.
+	template <typename T>
+	using lazy_dependency_ptr = detail::check_mode_choice_t<dependency_check_mode_v<T>, detail::lazy_ptr<T, true>, detail::lazy_ptr<T, false>>;
+}
+
+#pragma region implementation
+// --- lazy_binding
+template <typename T, bool counted>
+inline dptr::detail::lazy_binding<T, counted>::lazy_binding(source_site site) noexcept :
+	m_dependency(),
+	m_site(site)
+{
+}
+template <typename T, bool counted>
+inline dptr::detail::lazy_binding<T, counted>::lazy_binding(const lazy_binding& other) :
+	m_dependency(other.m_dependency, other.m_site),
+	m_site(other.m_site)
+{
+}
+template <typename T, bool counted>
+inline void dptr::detail::lazy_binding<T, counted>::bind(T* ptr)
+{
+	m_dependency.reset(ptr, m_site);
+}
+
+// --- lazy_ptr
+template <typename T, bool counted>
+inline dptr::detail::lazy_ptr<T, counted>::lazy_ptr() noexcept :
+	m_ptr(nullptr),
+	m_locked(false),
+	m_binding(source_site{}),
+	m_resolver()
+{
+}
+template <typename T, bool counted>
+inline dptr::detail::lazy_ptr<T, counted>::lazy_ptr(std::nullptr_t) noexcept :
+	lazy_ptr()
+{
+}
+template <typename T, bool counted>
+inline dptr::detail::lazy_ptr<T, counted>::lazy_ptr(resolver_type resolver, source_site site) noexcept :
+	m_ptr(nullptr),
+	m_locked(false),
+	m_binding(site),
+	m_resolver(std::move(resolver))
+{
+}
+template <typename T, bool counted>
+inline dptr::detail::lazy_ptr<T, counted>::lazy_ptr(const lazy_ptr& other) :
+	m_ptr(other.m_ptr.load(std::memory_order_acquire)),
+	m_locked(false),
+	m_binding(other.m_binding),
+	m_resolver(other.m_resolver)
+{
+}
+template <typename T, bool counted>
+inline dptr::detail::lazy_ptr<T, counted>::lazy_ptr(lazy_ptr&& other) noexcept :
+	m_ptr(other.m_ptr.exchange(nullptr, std::memory_order_acq_rel)),
+	m_locked(false),
+	m_binding(std::move(other.m_binding)),
+	m_resolver(std::move(other.m_resolver))
+{
+}
+template <typename T, bool counted>
+inline dptr::detail::lazy_ptr<T, counted>& dptr::detail::lazy_ptr<T, counted>::operator=(const lazy_ptr& other)
+{
+	if(&other != this)
+	{
+		m_binding = other.m_binding;
+		m_ptr.store(other.m_ptr.load(std::memory_order_acquire), std::memory_order_release);
+		m_resolver = other.m_resolver;
+	}
+	return *this;
+}
+template <typename T, bool counted>
+inline dptr::detail::lazy_ptr<T, counted>& dptr::detail::lazy_ptr<T, counted>::operator=(lazy_ptr&& other) noexcept
+{
+	if(&other != this)
+	{
+		m_binding = std::move(other.m_binding);
+		m_ptr.store(other.m_ptr.exchange(nullptr, std::memory_order_acq_rel), std::memory_order_release);
+		m_resolver = std::move(other.m_resolver);
+	}
+	return *this;
+}
+template <typename T, bool counted>
+inline void dptr::detail::lazy_ptr<T, counted>::reset(resolver_type resolver, source_site site)
+{
+	m_ptr.store(nullptr, std::memory_order_release);
+	m_binding = lazy_binding<T, counted>(site);
+	m_resolver = std::move(resolver);
+}
+template <typename T, bool counted>
+inline bool dptr::detail::lazy_ptr<T, counted>::bound() const noexcept
+{
+	return m_ptr.load(std::memory_order_acquire);
+}
+template <typename T, bool counted>
+inline T* dptr::detail::lazy_ptr<T, counted>::get() const
+{
+	T* const ptr = m_ptr.load(std::memory_order_acquire);
+	return ptr ? ptr : bind();
+}
+template <typename T, bool counted>
+inline T& dptr::detail::lazy_ptr<T, counted>::operator*() const
+{
+	T* const ptr = get();
+	DPTR_PRECONDITION(counted, ptr, "[dptr::lazy_dependency_ptr::operator*]: nullptr access (no resolver or the resolver returned nullptr).");
+	return *ptr;
+}
+template <typename T, bool counted>
+inline T* dptr::detail::lazy_ptr<T, counted>::operator->() const
+{
+	T* const ptr = get();
+	DPTR_PRECONDITION(counted, ptr, "[dptr::lazy_dependency_ptr::operator->]: nullptr access (no resolver or the resolver returned nullptr).");
+	return ptr;
+}
+template <typename T, bool counted>
+inline dptr::detail::lazy_ptr<T, counted>::operator bool() const
+{
+	return get();
+}
+template <typename T, bool counted>
+inline T* dptr::detail::lazy_ptr<T, counted>::bind() const
+{
+	// unlocks when the resolver throws
+	struct guard
+	{
+		const lazy_ptr& ptr;
+		~guard() { ptr.unlock(); }
+	};
+	lock();
+	const guard locked{*this};
+	T* ptr = m_ptr.load(std::memory_order_relaxed);
+	if(!ptr && m_resolver)
+	{
+		ptr = m_resolver();
+		if(ptr)
+		{
+			m_binding.bind(ptr);
+			m_ptr.store(ptr, std::memory_order_release);
+		}
+	}
+	return ptr;
+}
+template <typename T, bool counted>
+inline void dptr::detail::lazy_ptr<T, counted>::lock() const noexcept
+{
+	for(unsigned spins = 0u; m_locked.exchange(true, std::memory_order_acquire); ++spins)
+	{
+		while(m_locked.load(std::memory_order_relaxed))
+			if(++spins > 64u) std::this_thread::yield();
+	}
+}
+template <typename T, bool counted>
+inline void dptr::detail::lazy_ptr<T, counted>::unlock() const noexcept
+{
+	m_locked.store(false, std::memory_order_release);
+}
+#pragma endregion
+#endif
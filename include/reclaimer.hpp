@@ -0,0 +1,183 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_RECLAIMER_H_
+#define _DPTR_RECLAIMER_H_
+
+#include "dependency_ptr.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace dptr
+{
+	// Deferred destruction of shared, read-mostly dependencies (quiescent state based reclamation).
+	// Instead of destroying a replaced object while readers may still hold pointers to it, it is retired and destroyed by
+	// collect() once every registered reader thread has passed a quiescent state (a point where it holds no pointers to retired objects).
+	// Readers take no locks, a quiescent state costs a load and a store. Retiring and collecting lock a mutex.
+	// Readers must not hold dependency_ptrs to retired objects across quiescent states. In checked builds collect() asserts
+	// that objects whose grace period has passed are no longer referenced, which is what makes the release builds (without reference counts) safe.
+	class reclaimer
+	{
+	public:
+		// registers the calling thread as reader for its lifetime. a reader that never calls quiescent() blocks reclamation.
+		class reader
+		{
+		public:
+			explicit reader(reclaimer& domain);
+			reader(const reader&) = delete;
+			reader& operator=(const reader&) = delete;
+			~reader();
+			// announces that the thread holds no pointers to retired objects
+			void quiescent() noexcept;
+		private:
+			reclaimer& m_domain;
+			std::atomic<std::uint64_t>* m_observed;
+		};
+
+		reclaimer() = default;
+		reclaimer(const reclaimer&) = delete;
+		reclaimer& operator=(const reclaimer&) = delete;
+		// destroys all retired objects. asserts that no readers are registered.
+		~reclaimer();
+
+		// object must have been allocated with new and must no longer be reachable by readers that did not already load it
+		template <typename T>
+		void retire(T* object);
+		// destroys the retired objects whose grace period has passed, returns their number. call it off the hot path (e.g. periodically).
+		std::size_t collect();
+		// number of retired objects not yet destroyed
+		std::size_t pending() const;
+	private:
+		struct retired
+		{
+			void* object;
+			void (*destroy)(void*);
+			std::uint64_t epoch;
+		};
+		struct alignas(DPTR_CACHE_LINE_SIZE) reader_state
+		{
+			std::atomic<std::uint64_t> observed;
+		};
+		template <typename T>
+		static void destroy(void* object);
+		// the epoch all readers have passed. objects retired in an earlier epoch can be destroyed.
+		std::uint64_t safe_epoch() const noexcept;
+
+		std::atomic<std::uint64_t> m_epoch{1u};
+		mutable std::mutex m_mutex;
+		// ordered by epoch
+		std::vector<retired> m_retired;
+		std::vector<std::unique_ptr<reader_state>> m_readers;
+	};
+}
+
+#pragma region implementation
+// --- reader
+inline dptr::reclaimer::reader::reader(reclaimer& domain) :
+	m_domain(domain)
+{
+	std::lock_guard<std::mutex> lock(domain.m_mutex);
+	auto state = std::make_unique<reader_state>();
+	state->observed.store(domain.m_epoch.load(std::memory_order_acquire), std::memory_order_relaxed);
+	m_observed = &state->observed;
+	domain.m_readers.push_back(std::move(state));
+}
+inline dptr::reclaimer::reader::~reader()
+{
+	std::lock_guard<std::mutex> lock(m_domain.m_mutex);
+	for(auto it = m_domain.m_readers.begin(); it != m_domain.m_readers.end(); ++it)
+	{
+		if(&(*it)->observed == m_observed)
+		{
+			*it = std::move(m_domain.m_readers.back());
+			m_domain.m_readers.pop_back();
+			break;
+		}
+	}
+}
+inline void dptr::reclaimer::reader::quiescent() noexcept
+{
+	// release: the reads of retired objects happen before collect() sees the new epoch
+	m_observed->store(m_domain.m_epoch.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+// --- reclaimer
+inline dptr::reclaimer::~reclaimer()
+{
+	DPTR_ASSERT(m_readers.empty(), "[dptr::reclaimer::~reclaimer]: There were still readers registered.");
+	for(const retired& entry : m_retired)
+		entry.destroy(entry.object);
+}
+template <typename T>
+inline void dptr::reclaimer::retire(T* object)
+{
+	if(!object) return;
+	std::lock_guard<std::mutex> lock(m_mutex);
+	// readers passing a quiescent state from now on observe a later epoch
+	m_retired.push_back(retired{const_cast<void*>(static_cast<const void*>(object)), &destroy<T>, m_epoch.fetch_add(1u, std::memory_order_acq_rel)});
+}
+inline std::size_t dptr::reclaimer::collect()
+{
+	std::vector<retired> expired;
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		const std::uint64_t safe = safe_epoch();
+		std::size_t count = 0u;
+		while(count < m_retired.size() && m_retired[count].epoch < safe)
+			++count;
+		expired.assign(m_retired.begin(), m_retired.begin() + static_cast<std::ptrdiff_t>(count));
+		m_retired.erase(m_retired.begin(), m_retired.begin() + static_cast<std::ptrdiff_t>(count));
+	}
+	for(const retired& entry : expired)
+		entry.destroy(entry.object);
+	return expired.size();
+}
+inline std::size_t dptr::reclaimer::pending() const
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_retired.size();
+}
+template <typename T>
+inline void dptr::reclaimer::destroy(void* object)
+{
+	T* const typed = static_cast<T*>(object);
+	// guarded dependencies forbidding destroy report it themselves
+	if constexpr(detail::needs_destroy_check<T>::value)
+		DPTR_ASSERT_UNREFERENCED(dependency_op::destroy, detail::reference_count(typed), detail::dependency_address(typed), "[dptr::reclaimer::collect]: A retired object was still referenced after its grace period (pointers to retired objects must not be held across quiescent states).");
+	delete typed;
+}
+inline std::uint64_t dptr::reclaimer::safe_epoch() const noexcept
+{
+	std::uint64_t safe = m_epoch.load(std::memory_order_acquire);
+	for(const auto& state : m_readers)
+		safe = std::min(safe, state->observed.load(std::memory_order_acquire));
+	return safe;
+}
+#pragma endregion
+#endif
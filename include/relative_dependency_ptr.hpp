@@ -0,0 +1,204 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_RELATIVE_DEPENDENCY_PTR_H_
+#define _DPTR_RELATIVE_DEPENDENCY_PTR_H_
+
+#include "dependency_ptr.hpp"
+
+namespace dptr
+{
+	namespace detail
+	{
+		// Self-relative pointer: stores the distance from its own address to the target minus one, so that 0 (a target inside
+		// the pointer itself, which cannot exist) is nullptr and zero filled memory holds null pointers.
+		// Copying and moving recompute the offset for the new address. counted pointers add a reference to the target.
+		template <typename T, typename offset_type, bool counted>
+		class relative_ptr
+		{
+			static_assert(std::is_integral_v<offset_type> && std::is_signed_v<offset_type> && sizeof(offset_type) > 1u, "[dptr::detail::relative_ptr]: offset_type has to be a signed integer type of at least two bytes.");
+		public:
+			using element_type = T;
+			using pointer = T*;
+
+			relative_ptr() noexcept;
+			relative_ptr(std::nullptr_t) noexcept;
+			relative_ptr(T* ptr) noexcept;
+			relative_ptr(const relative_ptr& other) noexcept;
+			relative_ptr(relative_ptr&& other) noexcept;
+			relative_ptr& operator=(const relative_ptr& other) noexcept;
+			relative_ptr& operator=(relative_ptr&& other) noexcept;
+			relative_ptr& operator=(T* ptr) noexcept;
+			~relative_ptr();
+
+			void reset(T* ptr = nullptr) noexcept;
+
+			T& operator*() const noexcept;
+			T* operator->() const noexcept;
+			T* get() const noexcept;
+			explicit operator bool() const noexcept;
+			operator T*() const noexcept;
+		private:
+			// sets the offset without touching reference counts
+			void store(T* ptr) noexcept;
+
+			offset_type m_offset;
+		};
+	}
+
+	// Position-independent dependency_ptr for object graphs in memory mapped files or shared memory. Stores the signed distance
+	// from the pointer to its target (32 bit by default, so both have to be within +-2 GiB), so the graph stays valid wherever it is mapped
+	// and needs no pointer fixups after loading. Dereferencing costs a test and an add, sizeof is sizeof(offset_type) in all builds.
+	// In checked builds, the pointer adds a reference to its target like dependency_ptr (without holder tracking).
+	// A counter stored in the object (guarded_dependency) therefore matches the pointers of a mapped image written by a build with the same check mode.
+	// Images are not portable between check modes, as the size of guarded_dependency differs.
+	// A pointer may reference the object at its own address (e.g. a node whose first member points to the node), in all check modes.
+	template <typename T, typename offset_type = std::int32_t>
+	using relative_dependency_ptr = detail::check_mode_choice_t<dependency_check_mode_v<T>, detail::relative_ptr<T, offset_type, true>, detail::relative_ptr<T, offset_type, false>>;
+}
+
+#pragma region implementation
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>::relative_ptr() noexcept :
+	m_offset(0)
+{
+}
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>::relative_ptr(std::nullptr_t) noexcept :
+	m_offset(0)
+{
+}
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>::relative_ptr(T* ptr) noexcept :
+	m_offset(0)
+{
+	reset(ptr);
+}
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>::relative_ptr(const relative_ptr& other) noexcept :
+	m_offset(0)
+{
+	reset(other.get());
+}
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>::relative_ptr(relative_ptr&& other) noexcept :
+	m_offset(0)
+{
+	// the reference of other is taken over
+	store(other.get());
+	other.m_offset = 0;
+}
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>& dptr::detail::relative_ptr<T, offset_type, counted>::operator=(const relative_ptr& other) noexcept
+{
+	reset(other.get());
+	return *this;
+}
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>& dptr::detail::relative_ptr<T, offset_type, counted>::operator=(relative_ptr&& other) noexcept
+{
+	if(&other != this)
+	{
+		T* const ptr = other.get();
+		other.m_offset = 0;
+		if constexpr(counted)
+			if(T* const old = get()) intrusive_ptr_release(old);
+		store(ptr);
+	}
+	return *this;
+}
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>& dptr::detail::relative_ptr<T, offset_type, counted>::operator=(T* ptr) noexcept
+{
+	reset(ptr);
+	return *this;
+}
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>::~relative_ptr()
+{
+	if constexpr(counted)
+	{
+		// checked here instead of in the class, where T may still be incomplete
+		static_assert(is_checked_dependency_v<std::remove_cv_t<T>>, "[dptr::detail::relative_ptr]: relative_dependency_ptr can only be used with types deriving guarded_dependency or arena_dependency or side table dependencies.");
+		if(T* const ptr = get()) intrusive_ptr_release(ptr);
+	}
+}
+template <typename T, typename offset_type, bool counted>
+inline void dptr::detail::relative_ptr<T, offset_type, counted>::reset(T* ptr) noexcept
+{
+	if constexpr(counted)
+	{
+		// add first, ptr may be the current target
+		if(ptr) intrusive_ptr_add_ref(ptr);
+		if(T* const old = get()) intrusive_ptr_release(old);
+	}
+	store(ptr);
+}
+template <typename T, typename offset_type, bool counted>
+inline void dptr::detail::relative_ptr<T, offset_type, counted>::store(T* ptr) noexcept
+{
+	if(!ptr)
+	{
+		m_offset = 0;
+		return;
+	}
+	// unsigned arithmetic, the distance may be negative. never 1 (nullptr), no object starts inside the pointer.
+	const std::intptr_t offset = static_cast<std::intptr_t>(reinterpret_cast<std::uintptr_t>(ptr) - reinterpret_cast<std::uintptr_t>(this) - 1u);
+	// checked in all builds, an offset which does not fit would silently point elsewhere
+	if constexpr(sizeof(offset_type) < sizeof(std::intptr_t))
+		DPTR_ASSERT(offset >= std::numeric_limits<offset_type>::min() && offset <= std::numeric_limits<offset_type>::max(), "[dptr::relative_dependency_ptr::reset]: The target is too far away from the pointer for its offset type.");
+	m_offset = static_cast<offset_type>(offset);
+}
+template <typename T, typename offset_type, bool counted>
+inline T& dptr::detail::relative_ptr<T, offset_type, counted>::operator*() const noexcept
+{
+	DPTR_PRECONDITION(counted, m_offset, "[dptr::relative_dependency_ptr::operator*]: nullptr access.");
+	return *get();
+}
+template <typename T, typename offset_type, bool counted>
+inline T* dptr::detail::relative_ptr<T, offset_type, counted>::operator->() const noexcept
+{
+	DPTR_PRECONDITION(counted, m_offset, "[dptr::relative_dependency_ptr::operator->]: nullptr access.");
+	return get();
+}
+template <typename T, typename offset_type, bool counted>
+inline T* dptr::detail::relative_ptr<T, offset_type, counted>::get() const noexcept
+{
+	if(!m_offset) return nullptr;
+	return reinterpret_cast<T*>(reinterpret_cast<std::uintptr_t>(this) + static_cast<std::uintptr_t>(static_cast<std::intptr_t>(m_offset)) + 1u);
+}
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>::operator bool() const noexcept
+{
+	return m_offset;
+}
+template <typename T, typename offset_type, bool counted>
+inline dptr::detail::relative_ptr<T, offset_type, counted>::operator T*() const noexcept
+{
+	return get();
+}
+#pragma endregion
+#endif
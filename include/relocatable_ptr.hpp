@@ -0,0 +1,315 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_RELOCATABLE_PTR_H_
+#define _DPTR_RELOCATABLE_PTR_H_
+
+#include "dependency_ptr.hpp"
+
+namespace dptr
+{
+	namespace detail
+	{
+		class relocation_link;
+
+		// --- intrusive list of the relocatable_ptrs referencing a relocatable_dependency
+		class relocation_list
+		{
+			friend class relocation_link;
+		protected:
+			relocation_list() noexcept = default;
+			relocation_list(const relocation_list&) = delete;
+			relocation_list& operator=(const relocation_list&) = delete;
+			~relocation_list() = default;
+
+			// moves all links of other to this object. the pointers are adjusted by the distance between the objects.
+			void take_links(relocation_list& other) noexcept;
+			// resets all links to nullptr
+			void drop_links() noexcept;
+			bool has_links() const noexcept;
+			std::size_t link_count() const noexcept;
+		private:
+			relocation_link* m_head = nullptr;
+		};
+
+		// --- node of a relocation_list, base of relocatable_ptr. stores the referenced (sub)object as void*.
+		class relocation_link
+		{
+			friend class relocation_list;
+		protected:
+			relocation_link() noexcept = default;
+			relocation_link(const relocation_link&) = delete;
+			relocation_link& operator=(const relocation_link&) = delete;
+			~relocation_link();
+
+			void link(relocation_list* list, void* object) noexcept;
+			void unlink() noexcept;
+			void* object() const noexcept { return m_object; }
+		private:
+			relocation_list* m_list = nullptr;
+			void* m_object = nullptr;
+			relocation_link* m_prev = nullptr;
+			relocation_link* m_next = nullptr;
+		};
+	}
+
+	// Base class of dependencies that may be moved while they are referenced. Keeps an intrusive list of the relocatable_ptrs
+	// referencing it. Moving the object (including relocations by std::vector) retargets all of them to the new object,
+	// so dependencies can be stored contiguously. Move assignment retargets the pointers to the moved-from object as well.
+	// In contrast to guarded_dependency, the list also exists in release builds. forbidden_ops (destroy, copy_assign, move_assign)
+	// are only checked if mode is not check_mode::off. Destroying a referenced object always resets its pointers to nullptr.
+	// Not thread-safe: pointers to the same object must not be created, copied or destroyed concurrently.
+	template <dependency_op_flags forbidden_ops = dependency_op::destroy | dependency_op::assign, check_mode mode = default_check_mode>
+	class relocatable_dependency : private detail::relocation_list
+	{
+		template <typename T> friend class relocatable_ptr;
+	public:
+		static constexpr dependency_op_flags dep_forbidden_op_flags = forbidden_ops;
+		using relocatable_dependency_base = relocatable_dependency;
+		// relocatable_ptrs referencing this object (walks the list)
+		std::size_t relocatable_references() const noexcept;
+	protected:
+		relocatable_dependency() noexcept = default;
+		// copies are new objects without pointers
+		relocatable_dependency(const relocatable_dependency&) noexcept;
+		relocatable_dependency(relocatable_dependency&& other) noexcept;
+		relocatable_dependency& operator=(const relocatable_dependency&) noexcept;
+		relocatable_dependency& operator=(relocatable_dependency&& other) noexcept;
+		~relocatable_dependency();
+	private:
+		static constexpr bool checked = mode != check_mode::off;
+	};
+
+	// Pointer to a relocatable_dependency which follows the object when it is moved. Dereferencing costs the same as a T*,
+	// creating, copying and destroying the pointer links it into / unlinks it from the list of its target.
+	// T has to derive exactly one relocatable_dependency.
+	template <typename T>
+	class relocatable_ptr : private detail::relocation_link
+	{
+	public:
+		using element_type = T;
+		using pointer = T*;
+
+		relocatable_ptr() noexcept = default;
+		relocatable_ptr(std::nullptr_t) noexcept;
+		relocatable_ptr(T* ptr) noexcept;
+		relocatable_ptr(const relocatable_ptr& other) noexcept;
+		template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+		relocatable_ptr(const relocatable_ptr<U>& other) noexcept;
+		relocatable_ptr& operator=(const relocatable_ptr& other) noexcept;
+		relocatable_ptr& operator=(T* ptr) noexcept;
+		~relocatable_ptr() = default;
+
+		void reset(T* ptr = nullptr) noexcept;
+
+		T& operator*() const noexcept;
+		T* operator->() const noexcept;
+		T* get() const noexcept;
+		explicit operator bool() const noexcept;
+		operator T*() const noexcept;
+	};
+}
+
+#pragma region implementation
+// --- relocation_list
+inline void dptr::detail::relocation_list::take_links(relocation_list& other) noexcept
+{
+	if(!other.m_head) return;
+	const std::ptrdiff_t distance = reinterpret_cast<const char*>(this) - reinterpret_cast<const char*>(&other);
+	relocation_link* last = nullptr;
+	for(relocation_link* link = other.m_head; link; link = link->m_next)
+	{
+		link->m_list = this;
+		link->m_object = static_cast<char*>(link->m_object) + distance;
+		last = link;
+	}
+	last->m_next = m_head;
+	if(m_head) m_head->m_prev = last;
+	m_head = other.m_head;
+	other.m_head = nullptr;
+}
+inline void dptr::detail::relocation_list::drop_links() noexcept
+{
+	while(m_head)
+		m_head->unlink();
+}
+inline bool dptr::detail::relocation_list::has_links() const noexcept
+{
+	return m_head;
+}
+inline std::size_t dptr::detail::relocation_list::link_count() const noexcept
+{
+	std::size_t count = 0u;
+	for(const relocation_link* link = m_head; link; link = link->m_next)
+		++count;
+	return count;
+}
+
+// --- relocation_link
+inline dptr::detail::relocation_link::~relocation_link()
+{
+	unlink();
+}
+inline void dptr::detail::relocation_link::link(relocation_list* list, void* object) noexcept
+{
+	unlink();
+	if(!list) return;
+	m_list = list;
+	m_object = object;
+	m_next = list->m_head;
+	if(m_next) m_next->m_prev = this;
+	list->m_head = this;
+}
+inline void dptr::detail::relocation_link::unlink() noexcept
+{
+	if(m_list)
+	{
+		if(m_prev) m_prev->m_next = m_next;
+		else m_list->m_head = m_next;
+		if(m_next) m_next->m_prev = m_prev;
+	}
+	m_list = nullptr;
+	m_object = nullptr;
+	m_prev = m_next = nullptr;
+}
+
+// --- relocatable_dependency
+template <dptr::dependency_op_flags forbidden_ops, dptr::check_mode mode>
+inline dptr::relocatable_dependency<forbidden_ops, mode>::relocatable_dependency(const relocatable_dependency&) noexcept :
+	relocation_list()
+{
+}
+template <dptr::dependency_op_flags forbidden_ops, dptr::check_mode mode>
+inline dptr::relocatable_dependency<forbidden_ops, mode>::relocatable_dependency(relocatable_dependency&& other) noexcept :
+	relocation_list()
+{
+	take_links(other);
+}
+template <dptr::dependency_op_flags forbidden_ops, dptr::check_mode mode>
+inline dptr::relocatable_dependency<forbidden_ops, mode>& dptr::relocatable_dependency<forbidden_ops, mode>::operator=(const relocatable_dependency&) noexcept
+{
+	// object stays at the same address => pointers stay
+	if constexpr(checked && (forbidden_ops & dependency_op::copy_assign))
+		DPTR_ASSERT(!has_links(), "[dptr::relocatable_dependency::operator=(copy)]: There were still (now possibly invalid!) pointers referencing the assigned object.");
+	return *this;
+}
+template <dptr::dependency_op_flags forbidden_ops, dptr::check_mode mode>
+inline dptr::relocatable_dependency<forbidden_ops, mode>& dptr::relocatable_dependency<forbidden_ops, mode>::operator=(relocatable_dependency&& other) noexcept
+{
+	if constexpr(checked && (forbidden_ops & dependency_op::move_assign))
+		DPTR_ASSERT(!has_links(), "[dptr::relocatable_dependency::operator=(move)]: There were still (now possibly invalid!) pointers referencing the assigned object.");
+	// the value of other now lives here
+	if(&other != this) take_links(other);
+	return *this;
+}
+template <dptr::dependency_op_flags forbidden_ops, dptr::check_mode mode>
+inline dptr::relocatable_dependency<forbidden_ops, mode>::~relocatable_dependency()
+{
+	if constexpr(checked && (forbidden_ops & dependency_op::destroy))
+		DPTR_ASSERT(!has_links(), "[dptr::relocatable_dependency::~relocatable_dependency]: There were still pointers referencing this object (reset to nullptr).");
+	drop_links();
+}
+template <dptr::dependency_op_flags forbidden_ops, dptr::check_mode mode>
+inline std::size_t dptr::relocatable_dependency<forbidden_ops, mode>::relocatable_references() const noexcept
+{
+	return link_count();
+}
+
+// --- relocatable_ptr
+template <typename T>
+inline dptr::relocatable_ptr<T>::relocatable_ptr(std::nullptr_t) noexcept :
+	relocation_link()
+{
+}
+template <typename T>
+inline dptr::relocatable_ptr<T>::relocatable_ptr(T* ptr) noexcept :
+	relocation_link()
+{
+	reset(ptr);
+}
+template <typename T>
+inline dptr::relocatable_ptr<T>::relocatable_ptr(const relocatable_ptr& other) noexcept :
+	relocation_link()
+{
+	reset(other.get());
+}
+template <typename T>
+template <typename U, typename>
+inline dptr::relocatable_ptr<T>::relocatable_ptr(const relocatable_ptr<U>& other) noexcept :
+	relocation_link()
+{
+	reset(other.get());
+}
+template <typename T>
+inline dptr::relocatable_ptr<T>& dptr::relocatable_ptr<T>::operator=(const relocatable_ptr& other) noexcept
+{
+	reset(other.get());
+	return *this;
+}
+template <typename T>
+inline dptr::relocatable_ptr<T>& dptr::relocatable_ptr<T>::operator=(T* ptr) noexcept
+{
+	reset(ptr);
+	return *this;
+}
+template <typename T>
+inline void dptr::relocatable_ptr<T>::reset(T* ptr) noexcept
+{
+	using dependency_t = std::remove_cv_t<T>;
+	dependency_t* const object = const_cast<dependency_t*>(ptr);
+	// relocatable_ptr is a friend of relocatable_dependency, so it can access its relocation_list base
+	typename dependency_t::relocatable_dependency_base* const dependency = object;
+	link(dependency, object);
+}
+template <typename T>
+inline T& dptr::relocatable_ptr<T>::operator*() const noexcept
+{
+	DPTR_PRECONDITION(std::remove_cv_t<T>::relocatable_dependency_base::checked, object(), "[dptr::relocatable_ptr::operator*]: nullptr access.");
+	return *get();
+}
+template <typename T>
+inline T* dptr::relocatable_ptr<T>::operator->() const noexcept
+{
+	DPTR_PRECONDITION(std::remove_cv_t<T>::relocatable_dependency_base::checked, object(), "[dptr::relocatable_ptr::operator->]: nullptr access.");
+	return get();
+}
+template <typename T>
+inline T* dptr::relocatable_ptr<T>::get() const noexcept
+{
+	return static_cast<T*>(object());
+}
+template <typename T>
+inline dptr::relocatable_ptr<T>::operator bool() const noexcept
+{
+	return object();
+}
+template <typename T>
+inline dptr::relocatable_ptr<T>::operator T*() const noexcept
+{
+	return get();
+}
+#pragma endregion
+#endif
@@ -0,0 +1,305 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_TEARDOWN_SCHEDULER_H_
+#define _DPTR_TEARDOWN_SCHEDULER_H_
+
+#include "dependency_ptr.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dptr
+{
+	struct teardown_result
+	{
+		std::size_t destroyed;
+		// distinct ordering constraints between registered objects (observed and declared)
+		std::size_t edges;
+		// objects which were still referenced when nothing else could be destroyed, destroyed after all others
+		std::size_t blocked;
+	};
+
+	// Destroys a set of owned objects in dependency order, running independent objects in parallel on a pool of threads.
+	// In checked builds, an object is destroyed once its reference count drops to 0, so destroying the objects referencing it
+	// (directly or through containers they own) releases it. Edges holder -> dependency (the object containing a dependency_ptr has to be
+	// destroyed before the object it references) are used to find the objects to check next. With DPTR_TRACK_HOLDERS they are observed
+	// from the dependency_ptrs stored directly inside registered objects, add_edge declares others. In release builds only declared edges order the teardown.
+	// Cycles of unreferenced objects (e.g. declared in both directions) are broken by destroying their last registered object first, without a report.
+	// Objects which are still referenced when nothing else can be destroyed (cycles, pointers outside of the registered objects) are reported
+	// with operation destroy and their reference count (and holders with DPTR_TRACK_HOLDERS), then destroyed in reverse registration order.
+	// In release builds nothing is counted, so nothing is reported and only the declared edges order the teardown.
+	// Registering types with non thread-safe reference counters makes run() destroy all objects on the calling thread.
+	// Registering objects and run() are not thread-safe.
+	class teardown_scheduler
+	{
+	public:
+		teardown_scheduler() noexcept = default;
+		teardown_scheduler(const teardown_scheduler&) = delete;
+		teardown_scheduler& operator=(const teardown_scheduler&) = delete;
+		// destroys the remaining objects on the calling thread
+		~teardown_scheduler();
+
+		template <typename T>
+		void add(std::unique_ptr<T> object);
+		// deleter(object) destroys the object
+		template <typename T, typename deleter_t>
+		void add(T* object, deleter_t deleter);
+		// holder has to be destroyed before dependency. both are addresses inside registered objects.
+		void add_edge(const void* holder, const void* dependency);
+
+		// destroys all registered objects using up to thread_count threads (including the calling thread)
+		teardown_result run(std::size_t thread_count = std::thread::hardware_concurrency());
+		std::size_t size() const noexcept;
+	private:
+		struct entry
+		{
+			const void* object;
+			std::size_t size;
+			// address identifying the object in violation reports (its guarded_dependency base for checked types)
+			const void* dependency;
+			std::function<void()> destroy;
+			// reports a violation if the object is still referenced, nullptr if the object reports that itself or is unchecked
+			void (*check)(const void*);
+			// reference count, nullptr for unchecked types
+			std::size_t (*references)(const void*);
+		};
+		std::size_t references(const entry& e) const noexcept;
+
+		template <typename T>
+		void add_entry(T* object, std::function<void()> destroy);
+		// entry containing address or entries.size(). by_address holds the entry indices sorted by address.
+		std::size_t entry_of(const void* address, const std::vector<std::size_t>& by_address) const noexcept;
+		void destroy(entry& e) noexcept;
+
+		std::vector<entry> m_entries;
+		std::vector<std::pair<const void*, const void*>> m_declared_edges;
+		bool m_serial = false;
+	};
+}
+
+#pragma region implementation
+inline dptr::teardown_scheduler::~teardown_scheduler()
+{
+	if(!m_entries.empty()) run(1u);
+}
+template <typename T>
+inline void dptr::teardown_scheduler::add(std::unique_ptr<T> object)
+{
+	T* const ptr = object.get();
+	if(!ptr) return;
+	std::shared_ptr<T> owner(std::move(object));
+	add_entry(ptr, [owner]() mutable { owner.reset(); });
+}
+template <typename T, typename deleter_t>
+inline void dptr::teardown_scheduler::add(T* object, deleter_t deleter)
+{
+	if(!object) return;
+	add_entry(object, [object, deleter]() mutable { deleter(object); });
+}
+template <typename T>
+inline void dptr::teardown_scheduler::add_entry(T* object, std::function<void()> destroy)
+{
+	const void* dependency = object;
+	void (*check)(const void*) = nullptr;
+	std::size_t (*references)(const void*) = nullptr;
+	if constexpr(detail::needs_destroy_check<T>::value)
+	{
+		check = [](const void* ptr)
+		{
+			const T* const object = static_cast<const T*>(ptr);
+			DPTR_ASSERT_UNREFERENCED(dependency_op::destroy, detail::reference_count(object), detail::dependency_address(object), "[dptr::teardown_scheduler::run]: There were still (now dangling!) pointers referencing this object when it was destroyed.");
+		};
+	}
+	if constexpr(detail::is_checked_dependency_v<T>)
+	{
+		dependency = detail::dependency_address(object);
+		references = [](const void* ptr) { return detail::reference_count(static_cast<const T*>(ptr)); };
+		// the references to the object may be released by several threads at once
+		m_serial |= !detail::is_ref_counter_atomic<T>::value;
+	}
+	m_entries.push_back({static_cast<const void*>(object), sizeof(T), dependency, std::move(destroy), check, references});
+}
+inline void dptr::teardown_scheduler::add_edge(const void* holder, const void* dependency)
+{
+	m_declared_edges.emplace_back(holder, dependency);
+}
+inline std::size_t dptr::teardown_scheduler::size() const noexcept
+{
+	return m_entries.size();
+}
+inline std::size_t dptr::teardown_scheduler::entry_of(const void* address, const std::vector<std::size_t>& by_address) const noexcept
+{
+	const std::less<const void*> less;
+	auto it = std::upper_bound(by_address.begin(), by_address.end(), address, [&](const void* value, std::size_t index) { return less(value, m_entries[index].object); });
+	if(it == by_address.begin()) return m_entries.size();
+	const entry& candidate = m_entries[*--it];
+	return less(address, static_cast<const unsigned char*>(candidate.object) + candidate.size) ? *it : m_entries.size();
+}
+inline std::size_t dptr::teardown_scheduler::references(const entry& e) const noexcept
+{
+	return e.references ? e.references(e.object) : 0u;
+}
+inline void dptr::teardown_scheduler::destroy(entry& e) noexcept
+{
+	if(e.check) e.check(e.object);
+	e.destroy();
+	e.destroy = nullptr;
+}
+inline dptr::teardown_result dptr::teardown_scheduler::run(std::size_t thread_count)
+{
+	const std::size_t entry_count = m_entries.size();
+	std::vector<std::size_t> by_address(entry_count);
+	for(std::size_t i = 0u; i < entry_count; ++i) by_address[i] = i;
+	std::sort(by_address.begin(), by_address.end(), [this](std::size_t lhs, std::size_t rhs) { return std::less<const void*>()(m_entries[lhs].object, m_entries[rhs].object); });
+
+	// successors[i]: objects i references, which have to outlive it
+	std::vector<std::vector<std::size_t>> successors(entry_count);
+	std::vector<std::size_t> in_degree(entry_count, 0u);
+	teardown_result result{0u, 0u, 0u};
+	const auto add = [&](const void* holder, const void* dependency)
+	{
+		const std::size_t from = entry_of(holder, by_address);
+		const std::size_t to = entry_of(dependency, by_address);
+		if(from == entry_count || to == entry_count || from == to) return;
+		successors[from].push_back(to);
+	};
+	for(const auto& declared : m_declared_edges)
+		add(declared.first, declared.second);
+	#if DPTR_TRACK_HOLDERS
+	std::vector<std::pair<const void*, const void*>> observed;
+	for_each_holder([&observed](const holder_info& holder) { observed.emplace_back(holder.holder, holder.object); });
+	for(const auto& edge : observed)
+		add(edge.first, edge.second);
+	#endif
+	// an edge may be declared several times, or declared and observed
+	for(std::vector<std::size_t>& targets : successors)
+	{
+		std::sort(targets.begin(), targets.end());
+		targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+		for(const std::size_t to : targets) ++in_degree[to];
+		result.edges += targets.size();
+	}
+
+	// objects without incoming edges are destroyed once they are unreferenced. objects which are still referenced wait
+	// until nothing else is ready or running and are checked again. if there are none, a cycle is broken by destroying
+	// its last registered unreferenced object (in release builds, where nothing is counted, any object of the cycle).
+	std::vector<std::size_t> ready, waiting;
+	std::vector<char> queued(entry_count, 0);
+	const auto make_ready = [&](std::size_t index)
+	{
+		if(queued[index]) return;
+		queued[index] = 1;
+		(references(m_entries[index]) == 0u ? ready : waiting).push_back(index);
+	};
+	for(std::size_t i = entry_count; i-- > 0u;)
+		if(in_degree[i] == 0u) make_ready(i);
+	std::mutex mutex;
+	std::condition_variable ready_changed;
+	std::size_t running = 0u;
+	const auto work = [&]()
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		for(;;)
+		{
+			ready_changed.wait(lock, [&]() { return !ready.empty() || running == 0u; });
+			if(ready.empty())
+			{
+				// nothing is running, so the counts of the waiting objects are final
+				const auto unreferenced = std::partition(waiting.begin(), waiting.end(), [&](std::size_t index) { return references(m_entries[index]) != 0u; });
+				ready.insert(ready.end(), unreferenced, waiting.end());
+				waiting.erase(unreferenced, waiting.end());
+				for(std::size_t i = entry_count; ready.empty() && i-- > 0u;)
+				{
+					if(queued[i] || references(m_entries[i]) != 0u) continue;
+					queued[i] = 1;
+					ready.push_back(i);
+				}
+				if(ready.empty()) return;
+				ready_changed.notify_all();
+			}
+			const std::size_t index = ready.back();
+			ready.pop_back();
+			++running;
+			lock.unlock();
+			destroy(m_entries[index]);
+			lock.lock();
+			--running;
+			++result.destroyed;
+			for(const std::size_t successor : successors[index])
+				if(--in_degree[successor] == 0u) make_ready(successor);
+			ready_changed.notify_all();
+		}
+	};
+	std::vector<std::thread> workers;
+	const std::size_t worker_count = m_serial ? 0u : std::min(std::max<std::size_t>(thread_count, 1u), std::max<std::size_t>(entry_count, 1u)) - 1u;
+	workers.reserve(worker_count);
+	for(std::size_t i = 0u; i < worker_count; ++i)
+		workers.emplace_back(work);
+	work();
+	for(std::thread& worker : workers)
+		worker.join();
+
+	// the remaining objects are still referenced, which only checked types can be
+	std::vector<std::size_t> blocked;
+	for(std::size_t i = entry_count; i-- > 0u;)
+	{
+		entry& e = m_entries[i];
+		if(!e.destroy) continue;
+		const std::size_t count = references(e);
+		if(count == 0u)
+		{
+			destroy(e);
+			++result.destroyed;
+			continue;
+		}
+		if(in_degree[i] != 0u)
+			DPTR_REPORT_VIOLATION(dependency_op::destroy, e.dependency, count, "references == 0", "[dptr::teardown_scheduler::run]: The object is part of a dependency cycle (or referenced from one) and still referenced. It is destroyed after all other objects.");
+		else
+			DPTR_REPORT_VIOLATION(dependency_op::destroy, e.dependency, count, "references == 0", "[dptr::teardown_scheduler::run]: The object is still referenced by pointers outside of the registered objects. It is destroyed after all other objects.");
+		blocked.push_back(i);
+	}
+	result.blocked = blocked.size();
+	// already reported above: neither the check nor the object's own destructor reports them again
+	for(const std::size_t i : blocked)
+	{
+		const entry& e = m_entries[i];
+		const detail::violation_suppression suppression(e.dependency);
+		e.destroy();
+		++result.destroyed;
+	}
+	m_entries.clear();
+	m_declared_edges.clear();
+	m_serial = false;
+	return result;
+}
+#pragma endregion
+#endif
@@ -0,0 +1,152 @@
+// Author: Fabian Friederichs, 2021
+
+// Boost Software License - Version 1.0 - August 17th, 2003
+//
+// Permission is hereby granted, free of charge, to any person or organization
+// obtaining a copy of the software and accompanying documentation covered by
+// this license (the "Software") to use, reproduce, display, distribute,
+// execute, and transmit the Software, and to prepare derivative works of the
+// Software, and to permit third-parties to whom the Software is furnished to
+// do so, all subject to the following:
+//
+// The copyright notices in the Software and this entire statement, including
+// the above license grant, this restriction and the following disclaimer,
+// must be included in all copies of the Software, in whole or in part, and
+// all derivative works of the Software, unless such copies or derivative
+// works are solely in the form of machine-executable object code generated by
+// a source language processor.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE, TITLE AND NON-INFRINGEMENT. IN NO EVENT
+// SHALL THE COPYRIGHT HOLDERS OR ANYONE DISTRIBUTING THE SOFTWARE BE LIABLE
+// FOR ANY DAMAGES OR OTHER LIABILITY, WHETHER IN CONTRACT, TORT OR OTHERWISE,
+// ARISING FROM, OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+
+#ifndef _DPTR_WAIT_FOR_RELEASE_H_
+#define _DPTR_WAIT_FOR_RELEASE_H_
+
+#include "dependency_ptr.hpp"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace dptr
+{
+	namespace detail
+	{
+		// --- threads blocked in wait_for_release. the first waiting thread installs notify as the release hook of dependency_ptr.hpp,
+		// the last one to leave removes it again. releases which drop the count to 0 call notify while it is installed.
+		class release_waiters
+		{
+		public:
+			static void notify() noexcept;
+			// waits until unreferenced() returns true or deadline is reached. returns the last result of unreferenced().
+			template <typename predicate_t>
+			static bool wait_until(predicate_t&& unreferenced, std::chrono::steady_clock::time_point deadline);
+		private:
+			// a release racing with a thread starting to wait may not see the waiter (counters are updated with relaxed atomics),
+			// so waiters recheck the count at least this often instead of relying on being notified
+			static constexpr std::chrono::milliseconds recheck_interval{10};
+			// the waiter count and the hook (release_hook_storage) are only changed while holding mutex
+			struct state
+			{
+				std::mutex mutex;
+				std::condition_variable released;
+			};
+			static state& instance() noexcept;
+		};
+
+		// now + timeout, saturated to time_point::max() for very long (or infinite) timeouts
+		template <typename rep, typename period>
+		std::chrono::steady_clock::time_point deadline_after(const std::chrono::duration<rep, period>& timeout) noexcept;
+	}
+
+	// blocks the calling thread until no dependency_ptr references dependency, e.g. before destroying it during a concurrent shutdown.
+	// for atomic guarded and side table dependencies. arena dependencies are only counted per arena and cannot be waited for.
+	// returns immediately for unchecked types (and unsampled objects in DPTR_CHECK_MODE_SAMPLED).
+	template <typename T>
+	void wait_for_release(const T& dependency);
+	// like wait_for_release, returns false if dependency was still referenced after timeout
+	template <typename T, typename rep, typename period>
+	bool wait_for_release(const T& dependency, const std::chrono::duration<rep, period>& timeout);
+}
+
+#pragma region implementation
+// --- release waiters
+inline dptr::detail::release_waiters::state& dptr::detail::release_waiters::instance() noexcept
+{
+	static state waiters;
+	return waiters;
+}
+inline void dptr::detail::release_waiters::notify() noexcept
+{
+	state& waiters = instance();
+	// taking the lock orders the notification after a waiter's check of the count
+	{
+		std::lock_guard<std::mutex> lock(waiters.mutex);
+	}
+	waiters.released.notify_all();
+}
+template <typename predicate_t>
+inline bool dptr::detail::release_waiters::wait_until(predicate_t&& unreferenced, std::chrono::steady_clock::time_point deadline)
+{
+	if(unreferenced()) return true;
+	state& waiters = instance();
+	release_hook_state& hooks = release_hook_storage();
+	std::unique_lock<std::mutex> lock(waiters.mutex);
+	if(hooks.waiting.fetch_add(1u) == 0u)
+		hooks.hook.store(&notify);
+	bool result = false;
+	while(!(result = unreferenced()))
+	{
+		const auto now = std::chrono::steady_clock::now();
+		if(now >= deadline) break;
+		waiters.released.wait_until(lock, deadline - now > recheck_interval ? now + recheck_interval : deadline);
+	}
+	if(hooks.waiting.fetch_sub(1u) == 1u)
+		hooks.hook.store(nullptr);
+	return result;
+}
+template <typename rep, typename period>
+inline std::chrono::steady_clock::time_point dptr::detail::deadline_after(const std::chrono::duration<rep, period>& timeout) noexcept
+{
+	using clock = std::chrono::steady_clock;
+	const clock::time_point now = clock::now();
+	// the remaining range of the clock, in its own duration. converting it to the caller's duration could overflow (e.g. hours or 32 bit reps),
+	// so both are compared as floating point durations. timeouts above half of it (more than a century) do not expire,
+	// which leaves room for rounding before the timeout is converted to the clock's duration.
+	const clock::duration remaining = clock::time_point::max() - now;
+	if(std::chrono::duration<double>(timeout) >= std::chrono::duration<double>(remaining) / 2.0)
+		return clock::time_point::max();
+	if(timeout <= timeout.zero())
+		return now;
+	return now + std::chrono::duration_cast<clock::duration>(timeout);
+}
+
+// --- wait_for_release
+template <typename T>
+inline void dptr::wait_for_release(const T& dependency)
+{
+	wait_for_release(dependency, std::chrono::steady_clock::duration::max());
+}
+template <typename T, typename rep, typename period>
+inline bool dptr::wait_for_release(const T& dependency, const std::chrono::duration<rep, period>& timeout)
+{
+	if constexpr(detail::is_checked_dependency_v<T>)
+	{
+		static_assert(!detail::is_arena_dependency<T>::value, "[dptr::wait_for_release]: Arena dependencies are counted per arena and cannot be waited for.");
+		static_assert(detail::is_ref_counter_atomic<T>::value, "[dptr::wait_for_release]: Only dependencies with thread-safe reference counters (atomic guarded or side table) can be waited for.");
+		return detail::release_waiters::wait_until([&dependency]() { return detail::reference_count(&dependency) == 0u; }, detail::deadline_after(timeout));
+	}
+	else
+	{
+		(void)dependency;
+		(void)timeout;
+		return true;
+	}
+}
+#pragma endregion
+#endif
@@ -0,0 +1,101 @@
+// Regression tests for atomic_dependency_ptr.hpp. Returns a non-zero exit code and prints the failed checks.
+
+#include "check.hpp"
+
+#include <atomic_dependency_ptr.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct config;
+}
+// checked independent of NDEBUG
+DPTR_DEPENDENCY_CHECK_MODE(config, full);
+
+namespace
+{
+	struct config : dptr::guarded_dependency_for<config, true>
+	{
+		int version = 0;
+	};
+
+	std::size_t count(const config& c) { return dptr::detail::reference_count(&c); }
+
+	// the atomic holds one reference to its target, loads and exchanges return counted pointers
+	void store_load_exchange()
+	{
+		config a, b;
+		{
+			dptr::atomic_dependency_ptr<config> current;
+			CHECK(current.load() == nullptr);
+			current.store(&a);
+			CHECK(count(a) == 1u);
+			{
+				dptr::dependency_ptr<config> loaded = current.load();
+				CHECK(loaded.get() == &a);
+				CHECK(count(a) == 2u);
+			}
+			CHECK(count(a) == 1u);
+
+			dptr::dependency_ptr<config> previous = current.exchange(&b);
+			CHECK(previous.get() == &a);
+			CHECK(count(a) == 1u);
+			CHECK(count(b) == 1u);
+			previous = nullptr;
+			CHECK(count(a) == 0u);
+
+			dptr::dependency_ptr<config> expected(&a);
+			CHECK(!current.compare_exchange_strong(expected, &a));
+			CHECK(expected.get() == &b);
+			CHECK(count(b) == 2u);
+			CHECK(current.compare_exchange_strong(expected, &a));
+			CHECK(count(a) == 1u);
+			CHECK(count(b) == 1u);
+			expected = nullptr;
+			current = nullptr;
+			CHECK(count(a) == 0u);
+		}
+		CHECK(count(a) == 0u);
+		CHECK(count(b) == 0u);
+	}
+
+	// readers load while a writer keeps replacing the target. every loaded pointer is released again.
+	void concurrent_loads()
+	{
+		config configs[4];
+		for(int i = 0; i < 4; ++i) configs[i].version = i;
+		{
+			dptr::atomic_dependency_ptr<config> current(&configs[0]);
+			std::atomic<bool> done{false};
+			std::atomic<bool> valid{true};
+			std::vector<std::thread> readers;
+			for(int t = 0; t < 4; ++t)
+			{
+				readers.emplace_back([&]()
+				{
+					while(!done.load())
+					{
+						const dptr::dependency_ptr<config> loaded = current.load();
+						if(!loaded || loaded->version < 0 || loaded->version >= 4) valid.store(false);
+					}
+				});
+			}
+			for(int i = 0; i < 10000; ++i)
+				current.store(&configs[i % 4]);
+			done.store(true);
+			for(std::thread& reader : readers) reader.join();
+			CHECK(valid.load());
+		}
+		for(const config& c : configs) CHECK(count(c) == 0u);
+	}
+}
+
+int main()
+{
+	store_load_exchange();
+	concurrent_loads();
+	return dptr_test::result();
+}
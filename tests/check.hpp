@@ -0,0 +1,28 @@
+// Minimal test helpers shared by the tests. A failed CHECK prints its location and makes the test return a non-zero exit code.
+
+#ifndef _DPTR_TESTS_CHECK_H_
+#define _DPTR_TESTS_CHECK_H_
+
+#include <dependency_ptr.hpp>
+
+#include <cstdlib>
+#include <iostream>
+
+namespace dptr_test
+{
+	inline int failures = 0;
+	// violations reported since the last call of reset_violations (counted instead of aborting, see count_violations)
+	inline int violations = 0;
+
+	inline void count_violation(const dptr::violation&) noexcept { ++violations; }
+	// replaces the default violation handler for the rest of the test
+	inline void count_violations() noexcept { dptr::set_violation_handler(&count_violation); }
+	inline void reset_violations() noexcept { violations = 0; }
+
+	inline int result() noexcept { return failures == 0 ? EXIT_SUCCESS : EXIT_FAILURE; }
+}
+
+#define CHECK(...)\
+	((__VA_ARGS__) ? (void)0 : (void)(++::dptr_test::failures, std::cerr << __FILE__ << ":" << __LINE__ << ": check failed: " #__VA_ARGS__ "\n"))
+
+#endif
@@ -0,0 +1,103 @@
+// Regression tests for dependency_alias.hpp. Returns a non-zero exit code and prints the failed checks.
+
+#include "check.hpp"
+
+#include <dependency_alias.hpp>
+
+#include <array>
+#include <vector>
+
+namespace
+{
+	struct mesh;
+	struct unchecked_mesh;
+}
+// checked independent of NDEBUG
+DPTR_DEPENDENCY_CHECK_MODE(mesh, full);
+DPTR_DEPENDENCY_CHECK_MODE(unchecked_mesh, off);
+
+namespace
+{
+	struct mesh : dptr::guarded_dependency_for<mesh>
+	{
+		std::vector<float> vertices = std::vector<float>(16u, 1.0f);
+		std::array<int, 4> ids{{1, 2, 3, 4}};
+		float x = 5.0f;
+	};
+	struct unchecked_mesh : dptr::guarded_dependency_for<unchecked_mesh>
+	{
+		float x = 1.0f;
+	};
+
+	std::size_t count(const mesh& m) { return dptr::detail::reference_count(&m); }
+
+	float sum(dptr::dependency_span<const float> values)
+	{
+		float result = 0.0f;
+		for(const float value : values) result += value;
+		return result;
+	}
+
+	// aliases count against their owner, copies add references, moves and resets transfer or drop them
+	void aliases()
+	{
+		mesh m;
+		dptr::dependency_ptr<mesh> owner(&m);
+		{
+			dptr::dependency_alias<float> x(owner, &owner->x);
+			CHECK(*x == 5.0f);
+			CHECK(count(m) == 2u);
+			dptr::dependency_alias<const float> copy = x;
+			CHECK(count(m) == 3u);
+			dptr::dependency_alias<float, mesh> typed(&m, &m.x);
+			CHECK(count(m) == 4u);
+			dptr::dependency_alias<float> moved(std::move(x));
+			CHECK(count(m) == 4u);
+			moved = nullptr;
+			CHECK(count(m) == 3u);
+		}
+		CHECK(count(m) == 1u);
+		owner = nullptr;
+		CHECK(count(m) == 0u);
+	}
+
+	// a span and all of its subranges hold one reference each to the owner
+	void spans()
+	{
+		mesh m;
+		{
+			dptr::dependency_span<float> vertices(&m, m.vertices);
+			dptr::dependency_span<int> ids(&m, m.ids);
+			CHECK(count(m) == 2u);
+			CHECK(vertices.size() == 16u);
+			CHECK(sum(vertices) == 16.0f);
+			CHECK(ids[3] == 4);
+			dptr::dependency_span<float> sub = vertices.subspan(2u, 4u);
+			CHECK(sub.size() == 4u);
+			CHECK(vertices.last(5u).size() == 5u);
+			CHECK(vertices.first(3u).size() == 3u);
+			CHECK(count(m) == 3u);
+			vertices = std::move(sub);
+			CHECK(vertices.size() == 4u);
+			CHECK(count(m) == 2u);
+		}
+		CHECK(count(m) == 0u);
+	}
+
+	// owners whose check mode is off are not counted, typed aliases of them are plain pointers
+	void unchecked_owners()
+	{
+		unchecked_mesh m;
+		dptr::dependency_alias<float, unchecked_mesh> x(&m, &m.x);
+		CHECK(*x == 1.0f);
+		CHECK(sizeof(x) == sizeof(float*));
+	}
+}
+
+int main()
+{
+	aliases();
+	spans();
+	unchecked_owners();
+	return dptr_test::result();
+}
@@ -0,0 +1,100 @@
+// Regression tests for guarded_pool.hpp. Returns a non-zero exit code and prints the failed checks.
+
+#include "check.hpp"
+
+#include <guarded_pool.hpp>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+	struct element
+	{
+		static inline int live = 0;
+		explicit element(int v) : value(v) { ++live; }
+		element(const element&) = delete;
+		element& operator=(const element&) = delete;
+		~element() { --live; }
+		int value;
+	};
+
+	std::vector<int> values(const dptr::guarded_pool<element, 8u>& pool)
+	{
+		std::vector<int> result;
+		for(const element& e : pool) result.push_back(e.value);
+		return result;
+	}
+
+	// erasing both neighbours of an element and then the element merges three runs, the middle slot has to read as erased
+	void adjacent_erase()
+	{
+		dptr::guarded_pool<element, 8u> pool;
+		element& a = pool.emplace(1);
+		element& b = pool.emplace(2);
+		element& c = pool.emplace(3);
+		element& d = pool.emplace(4);
+		pool.erase(&a);
+		pool.erase(&c);
+		pool.erase(&b);
+		CHECK(pool.size() == 1u);
+		CHECK(element::live == 1);
+		CHECK(!pool.contains(&a));
+		CHECK(!pool.contains(&b));
+		CHECK(!pool.contains(&c));
+		CHECK(pool.contains(&d));
+		CHECK(values(pool) == std::vector<int>{4});
+		CHECK(pool.stats().free_blocks == 2u);
+
+		// the merged run is reused from its first slot
+		element& e = pool.emplace(5);
+		CHECK(&e == &a);
+		CHECK(pool.contains(&e));
+		CHECK(!pool.contains(&b));
+		CHECK(values(pool) == std::vector<int>{5, 4});
+	}
+
+	// slots that were never used are not elements
+	void unused_slots()
+	{
+		dptr::guarded_pool<element, 8u> pool;
+		pool.reserve(16u);
+		element& a = pool.emplace(1);
+		CHECK(pool.contains(&a));
+		CHECK(!pool.contains(&a + 1));
+		CHECK(!pool.contains(&a + 7));
+		pool.clear();
+		CHECK(!pool.contains(&a));
+		CHECK(element::live == 0);
+	}
+
+	// every erase order leaves exactly the remaining elements
+	void erase_orders()
+	{
+		constexpr int count = 8;
+		std::vector<int> order{0, 1, 2, 3, 4, 5, 6, 7};
+		do
+		{
+			dptr::guarded_pool<element, 8u> pool;
+			std::vector<element*> elements;
+			for(int i = 0; i < count; ++i) elements.push_back(&pool.emplace(i));
+			for(int i = 0; i < count / 2; ++i) pool.erase(elements[order[i]]);
+			for(int i = 0; i < count; ++i)
+			{
+				const bool erased = std::find(order.begin(), order.begin() + count / 2, i) != order.begin() + count / 2;
+				CHECK(pool.contains(elements[i]) != erased);
+			}
+			CHECK(pool.size() == count / 2u);
+			CHECK(values(pool).size() == count / 2u);
+		} while(std::next_permutation(order.begin(), order.end()) && dptr_test::failures == 0);
+		CHECK(element::live == 0);
+	}
+}
+
+int main()
+{
+	adjacent_erase();
+	unused_slots();
+	erase_orders();
+	return dptr_test::result();
+}
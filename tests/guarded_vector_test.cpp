@@ -0,0 +1,88 @@
+// Regression tests for guarded_vector.hpp. Returns a non-zero exit code and prints the failed checks.
+
+#include "check.hpp"
+
+#include <guarded_vector.hpp>
+
+#include <vector>
+
+namespace
+{
+	struct particle;
+}
+// checked independent of NDEBUG
+DPTR_DEPENDENCY_CHECK_MODE(particle, full);
+
+namespace
+{
+	struct particle : dptr::guarded_element<false, dptr::default_counter<false>, dptr::dependency_check_mode_v<particle>>
+	{
+		int value = 0;
+	};
+
+	std::vector<std::size_t> indices;
+	void record_index(const dptr::violation& v) noexcept { indices.push_back(v.index); }
+
+	// only the referenced elements which are moved are reported, each with its index
+	void reported_indices()
+	{
+		dptr::guarded_vector<particle> particles;
+		particles.reserve(8u);
+		for(int i = 0; i < 6; ++i) particles.emplace_back().value = i;
+		dptr::dependency_ptr<particle> first(&particles[1]);
+		dptr::dependency_ptr<particle> second(&particles[4]);
+		CHECK(particles.references() == 2u);
+
+		indices.clear();
+		particles.erase(particles.begin() + 2);
+		CHECK(indices == std::vector<std::size_t>{4u});
+
+		// reference counts stay with the objects' addresses when the handler lets the erase continue
+		indices.clear();
+		particles.erase(particles.begin());
+		CHECK(indices == std::vector<std::size_t>{1u, 4u});
+		first = nullptr;
+		second = nullptr;
+	}
+
+	// an insertion which reallocates reports each referenced element once
+	void reallocating_insert()
+	{
+		dptr::guarded_vector<particle> particles;
+		particles.reserve(2u);
+		particles.emplace_back();
+		particles.emplace_back();
+		// intentionally leaked, the reallocation leaves it dangling
+		new dptr::dependency_ptr<particle>(&particles[1]);
+
+		indices.clear();
+		particles.insert(particles.begin(), particle());
+		CHECK(indices == std::vector<std::size_t>{1u});
+	}
+
+	// an insertion which does not reallocate only reports the referenced elements it moves
+	void shifting_insert()
+	{
+		dptr::guarded_vector<particle> particles;
+		particles.reserve(4u);
+		particles.emplace_back();
+		particles.emplace_back();
+		dptr::dependency_ptr<particle> front(&particles[0]);
+
+		indices.clear();
+		particles.emplace(particles.begin() + 1);
+		CHECK(indices.empty());
+		particles.emplace(particles.begin());
+		CHECK(indices == std::vector<std::size_t>{0u});
+		front = nullptr;
+	}
+}
+
+int main()
+{
+	dptr::set_violation_handler(&record_index);
+	reported_indices();
+	reallocating_insert();
+	shifting_insert();
+	return dptr_test::result();
+}
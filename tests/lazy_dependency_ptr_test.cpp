@@ -0,0 +1,102 @@
+// Regression tests for lazy_dependency_ptr.hpp. Returns a non-zero exit code and prints the failed checks.
+
+#include "check.hpp"
+
+#include <lazy_dependency_ptr.hpp>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	struct service;
+}
+// checked independent of NDEBUG
+DPTR_DEPENDENCY_CHECK_MODE(service, full);
+
+namespace
+{
+	struct service : dptr::guarded_dependency_for<service, true>
+	{
+		int value = 42;
+	};
+
+	std::size_t count(const service& s) { return dptr::detail::reference_count(&s); }
+
+	// the resolver is called once on first access, the bound pointer references the target until it is reset
+	void binds_once()
+	{
+		service s;
+		std::atomic<int> calls{0};
+		{
+			dptr::lazy_dependency_ptr<service> ptr([&]() { ++calls; return &s; });
+			CHECK(!ptr.bound());
+			CHECK(count(s) == 0u);
+
+			std::atomic<bool> valid{true};
+			std::vector<std::thread> threads;
+			for(int t = 0; t < 4; ++t)
+			{
+				threads.emplace_back([&]()
+				{
+					for(int i = 0; i < 1000; ++i)
+						if(ptr->value != 42) valid.store(false);
+				});
+			}
+			for(std::thread& thread : threads) thread.join();
+			CHECK(valid.load());
+			CHECK(calls.load() == 1);
+			CHECK(ptr.bound());
+			CHECK(count(s) == 1u);
+
+			dptr::lazy_dependency_ptr<service> copy(ptr);
+			CHECK(count(s) == 2u);
+			dptr::lazy_dependency_ptr<service> moved(std::move(copy));
+			CHECK(count(s) == 2u);
+			CHECK(!copy.bound());
+
+			ptr.reset([]() -> service* { return nullptr; });
+			CHECK(count(s) == 1u);
+			CHECK(!ptr);
+			CHECK(!ptr.bound());
+		}
+		CHECK(count(s) == 0u);
+		CHECK(calls.load() == 1);
+	}
+
+	// a resolver which throws binds nothing, the next access calls it again
+	void throwing_resolver()
+	{
+		service s;
+		int calls = 0;
+		dptr::lazy_dependency_ptr<service> ptr([&]() -> service*
+		{
+			if(++calls == 1) throw calls;
+			return &s;
+		});
+		bool thrown = false;
+		try
+		{
+			ptr.get();
+		}
+		catch(int)
+		{
+			thrown = true;
+		}
+		CHECK(thrown);
+		CHECK(!ptr.bound());
+		CHECK(ptr.get() == &s);
+		CHECK(calls == 2);
+		CHECK(count(s) == 1u);
+		ptr = nullptr;
+		CHECK(count(s) == 0u);
+	}
+}
+
+int main()
+{
+	binds_once();
+	throwing_resolver();
+	return dptr_test::result();
+}
@@ -0,0 +1,79 @@
+// Regression tests for reclaimer.hpp. Returns a non-zero exit code and prints the failed checks.
+
+#include "check.hpp"
+
+#include <reclaimer.hpp>
+
+namespace
+{
+	struct forbids_destroy;
+	struct allows_destroy;
+}
+// checked independent of NDEBUG
+DPTR_DEPENDENCY_CHECK_MODE(forbids_destroy, full);
+DPTR_DEPENDENCY_CHECK_MODE(allows_destroy, full);
+
+namespace
+{
+	int live = 0;
+
+	struct forbids_destroy : dptr::guarded_dependency_for<forbids_destroy, true>
+	{
+		forbids_destroy() noexcept { ++live; }
+		~forbids_destroy() { --live; }
+	};
+	struct allows_destroy : dptr::guarded_dependency_for<allows_destroy, true, dptr::dependency_op_flags{0u}>
+	{
+		allows_destroy() noexcept { ++live; }
+		~allows_destroy() { --live; }
+	};
+
+	// retired objects are destroyed once every reader passed a quiescent state
+	void grace_periods()
+	{
+		dptr::reclaimer domain;
+		{
+			dptr::reclaimer::reader reader(domain);
+			domain.retire(new forbids_destroy());
+			domain.retire(new allows_destroy());
+			CHECK(domain.pending() == 2u);
+			CHECK(domain.collect() == 0u);
+			CHECK(live == 2);
+
+			reader.quiescent();
+			domain.retire(new forbids_destroy());
+			CHECK(domain.collect() == 2u);
+			CHECK(domain.pending() == 1u);
+			CHECK(live == 1);
+		}
+		// no readers left
+		CHECK(domain.collect() == 1u);
+		CHECK(live == 0);
+		CHECK(dptr_test::violations == 0);
+	}
+
+	// objects still referenced after their grace period are reported once, by the object itself or by the reclaimer
+	void referenced_after_grace_period()
+	{
+		dptr_test::reset_violations();
+		dptr::reclaimer domain;
+		forbids_destroy* const first = new forbids_destroy();
+		allows_destroy* const second = new allows_destroy();
+		// intentionally leaked, releasing them after the objects were destroyed would access freed memory
+		new dptr::dependency_ptr<forbids_destroy>(first);
+		new dptr::dependency_ptr<allows_destroy>(second);
+		domain.retire(first);
+		domain.retire(second);
+		CHECK(domain.collect() == 2u);
+		CHECK(dptr_test::violations == 2);
+		CHECK(live == 0);
+	}
+}
+
+int main()
+{
+	dptr_test::count_violations();
+	grace_periods();
+	referenced_after_grace_period();
+	return dptr_test::result();
+}
@@ -0,0 +1,120 @@
+// Regression tests for teardown_scheduler.hpp. Returns a non-zero exit code and prints the failed checks.
+
+#include "check.hpp"
+
+#include <teardown_scheduler.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace
+{
+	struct node;
+}
+// checked independent of NDEBUG
+DPTR_DEPENDENCY_CHECK_MODE(node, full);
+
+namespace
+{
+	std::mutex order_mutex;
+	std::vector<int> order;
+
+	struct node : dptr::guarded_dependency_for<node, true, static_cast<dptr::dependency_op_flags>(dptr::dependency_op::destroy)>
+	{
+		int id;
+		dptr::dependency_ptr<node> next;
+		explicit node(int i) : id(i) {}
+		~node()
+		{
+			next = nullptr;
+			const std::lock_guard<std::mutex> lock(order_mutex);
+			order.push_back(id);
+		}
+	};
+
+	std::size_t position(int id)
+	{
+		for(std::size_t i = 0u; i < order.size(); ++i)
+			if(order[i] == id) return i;
+		return order.size();
+	}
+
+	// a <-> b declared in both directions (plus a duplicate), c -> a. nothing references anything, so nothing is reported.
+	void declared_cycle()
+	{
+		order.clear();
+		dptr_test::reset_violations();
+		dptr::teardown_scheduler scheduler;
+		auto a = std::make_unique<node>(1);
+		auto b = std::make_unique<node>(2);
+		auto c = std::make_unique<node>(3);
+		scheduler.add_edge(a.get(), b.get());
+		scheduler.add_edge(b.get(), a.get());
+		scheduler.add_edge(a.get(), b.get());
+		scheduler.add_edge(c.get(), a.get());
+		scheduler.add(std::move(a));
+		scheduler.add(std::move(b));
+		scheduler.add(std::move(c));
+		const dptr::teardown_result result = scheduler.run(2u);
+		CHECK(result.destroyed == 3u);
+		CHECK(result.edges == 3u);
+		CHECK(result.blocked == 0u);
+		CHECK(dptr_test::violations == 0);
+		CHECK(order.size() == 3u);
+		CHECK(position(3) < position(1));
+		CHECK(scheduler.size() == 0u);
+	}
+
+	// 1 -> 2 -> 3 through dependency_ptrs: each object is destroyed after the objects referencing it
+	void referenced_chain()
+	{
+		order.clear();
+		dptr_test::reset_violations();
+		dptr::teardown_scheduler scheduler;
+		auto n1 = std::make_unique<node>(1);
+		auto n2 = std::make_unique<node>(2);
+		auto n3 = std::make_unique<node>(3);
+		n1->next = n2.get();
+		n2->next = n3.get();
+		scheduler.add(std::move(n3));
+		scheduler.add(std::move(n2));
+		scheduler.add(std::move(n1));
+		const dptr::teardown_result result = scheduler.run(2u);
+		CHECK(result.destroyed == 3u);
+		CHECK(result.blocked == 0u);
+		CHECK(dptr_test::violations == 0);
+		CHECK(order == std::vector<int>{1, 2, 3});
+	}
+
+	// objects still referenced from outside when nothing else can be destroyed are reported once each
+	void referenced_cycle()
+	{
+		order.clear();
+		dptr_test::reset_violations();
+		dptr::teardown_scheduler scheduler;
+		auto a = std::make_unique<node>(1);
+		auto b = std::make_unique<node>(2);
+		scheduler.add_edge(a.get(), b.get());
+		scheduler.add_edge(b.get(), a.get());
+		// intentionally leaked, releasing them after the objects were destroyed would access freed memory
+		new dptr::dependency_ptr<node>(a.get());
+		new dptr::dependency_ptr<node>(b.get());
+		scheduler.add(std::move(a));
+		scheduler.add(std::move(b));
+		const dptr::teardown_result result = scheduler.run(2u);
+		CHECK(result.destroyed == 2u);
+		CHECK(result.blocked == 2u);
+		CHECK(dptr_test::violations == 2);
+		CHECK(order.size() == 2u);
+	}
+}
+
+int main()
+{
+	dptr_test::count_violations();
+	declared_cycle();
+	referenced_chain();
+	referenced_cycle();
+	return dptr_test::result();
+}
@@ -0,0 +1,89 @@
+// Regression tests for wait_for_release.hpp. Returns a non-zero exit code and prints the failed checks.
+
+#include "check.hpp"
+
+#include <wait_for_release.hpp>
+
+#include <chrono>
+#include <thread>
+
+namespace ext
+{
+	struct widget
+	{
+		int value = 0;
+	};
+}
+namespace
+{
+	struct service;
+}
+DPTR_SIDE_TABLE_DEPENDENCY(ext::widget);
+// checked independent of NDEBUG
+DPTR_DEPENDENCY_CHECK_MODE(ext::widget, full);
+DPTR_DEPENDENCY_CHECK_MODE(service, full);
+
+namespace
+{
+	struct service : dptr::guarded_dependency_for<service, true> {};
+
+	// ptr is reset by another thread after a short delay, wait_for_release has to block until then
+	template <typename T>
+	void released_by_other_thread(const T& object, dptr::dependency_ptr<T>& ptr)
+	{
+		CHECK(!dptr::wait_for_release(object, std::chrono::milliseconds(1)));
+		std::thread releaser([&ptr]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(20));
+			ptr = nullptr;
+		});
+		CHECK(dptr::wait_for_release(object, std::chrono::seconds(30)));
+		CHECK(dptr::detail::reference_count(&object) == 0u);
+		releaser.join();
+		CHECK(dptr::detail::release_hook_storage().waiting.load() == 0u);
+		CHECK(dptr::detail::release_hook_storage().hook.load() == nullptr);
+	}
+
+	void guarded()
+	{
+		service s;
+		CHECK(dptr::wait_for_release(s, std::chrono::seconds(0)));
+		dptr::dependency_ptr<service> ptr(&s);
+		released_by_other_thread(s, ptr);
+		dptr::wait_for_release(s);
+	}
+
+	void side_table()
+	{
+		ext::widget w;
+		CHECK(dptr::wait_for_release(w, std::chrono::seconds(0)));
+		dptr::dependency_ptr<ext::widget> ptr(&w);
+		dptr::dependency_ptr<ext::widget> copy(ptr);
+		CHECK(dptr::detail::reference_count(&w) == 2u);
+		copy = nullptr;
+		released_by_other_thread(w, ptr);
+		dptr::wait_for_release(w);
+	}
+
+	void timeouts()
+	{
+		service s;
+		dptr::dependency_ptr<service> ptr(&s);
+		CHECK(!dptr::wait_for_release(s, std::chrono::seconds(-1)));
+		CHECK(!dptr::wait_for_release(s, std::chrono::duration<int, std::milli>(5)));
+		// saturated deadlines
+		CHECK(dptr::detail::deadline_after(std::chrono::hours::max()) == std::chrono::steady_clock::time_point::max());
+		CHECK(dptr::detail::deadline_after(std::chrono::duration<double>(1e300)) == std::chrono::steady_clock::time_point::max());
+		CHECK(dptr::detail::deadline_after(std::chrono::duration<std::int32_t, std::ratio<3600>>(1)) > std::chrono::steady_clock::now());
+		ptr = nullptr;
+		CHECK(dptr::wait_for_release(s, std::chrono::hours::max()));
+	}
+}
+
+int main()
+{
+	guarded();
+	side_table();
+	timeouts();
+	return dptr_test::result();
+}